@@ -36,6 +36,7 @@
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
 #include "zoom_func.h"
+#include "spatial_index.h"
 
 #include "table/strings.h"
 
@@ -107,6 +108,31 @@ enum HelicopterRotorStates {
 	HRS_ROTOR_MOVING_3,
 };
 
+/** Filter for #FindNearestHangar accepting the airports an aircraft can be serviced at. */
+struct HangarFilter {
+	const Aircraft *v;                ///< The aircraft looking for a hangar.
+	const AircraftVehicleInfo *avi;   ///< Properties of the aircraft.
+	const Station *cur_dest;          ///< The airport the aircraft is heading to, if it has a limited range.
+
+	bool operator()(StationID index) const
+	{
+		const Station *st = Station::Get(index);
+		if (st->owner != this->v->owner || !(st->facilities & FACIL_AIRPORT)) return false;
+
+		const AirportFTAClass *afc = st->airport.GetFTA();
+		if (!st->airport.HasHangar() || (
+					/* don't crash the plane if we know it can't land at the airport */
+					(afc->flags & AirportFTAClass::SHORT_STRIP) &&
+					(this->avi->subtype & AIR_FAST) &&
+					!_cheats.no_jetcrash.value)) {
+			return false;
+		}
+
+		/* Check if our current destination can be reached from the depot airport. */
+		return this->cur_dest == NULL || DistanceSquare(st->airport.tile, this->cur_dest->airport.tile) <= this->v->acache.cached_max_range_sqr;
+	}
+};
+
 /**
  * Find the nearest hangar to v
  * INVALID_STATION is returned, if the company does not have any suitable
@@ -116,36 +142,16 @@ enum HelicopterRotorStates {
  */
 static StationID FindNearestHangar(const Aircraft *v)
 {
-	const Station *st;
-	uint best = 0;
-	StationID index = INVALID_STATION;
-	TileIndex vtile = TileVirtXY(v->x_pos, v->y_pos);
-	const AircraftVehicleInfo *avi = AircraftVehInfo(v->engine_type);
+	HangarFilter filter;
+	filter.v = v;
+	filter.avi = AircraftVehInfo(v->engine_type);
+	filter.cur_dest = v->acache.cached_max_range_sqr != 0 ? GetTargetAirportIfValid(v) : NULL;
 
-	FOR_ALL_STATIONS(st) {
-		if (st->owner != v->owner || !(st->facilities & FACIL_AIRPORT)) continue;
-
-		const AirportFTAClass *afc = st->airport.GetFTA();
-		if (!st->airport.HasHangar() || (
-					/* don't crash the plane if we know it can't land at the airport */
-					(afc->flags & AirportFTAClass::SHORT_STRIP) &&
-					(avi->subtype & AIR_FAST) &&
-					!_cheats.no_jetcrash.value)) {
-			continue;
-		}
+	/* v->tile can't be used here, when aircraft is flying v->tile is set to 0 */
+	TileIndex vtile = TileVirtXY(v->x_pos, v->y_pos);
 
-		/* v->tile can't be used here, when aircraft is flying v->tile is set to 0 */
-		uint distance = DistanceSquare(vtile, st->airport.tile);
-		if (v->acache.cached_max_range_sqr != 0) {
-			/* Check if our current destination can be reached from the depot airport. */
-			const Station *cur_dest = GetTargetAirportIfValid(v);
-			if (cur_dest != NULL && DistanceSquare(st->airport.tile, cur_dest->airport.tile) > v->acache.cached_max_range_sqr) continue;
-		}
-		if (distance < best || index == INVALID_STATION) {
-			best = distance;
-			index = st->index;
-		}
-	}
+	StationID index;
+	if (!_airport_spatial_index.FindNearest(vtile, SM_SQUARE, UINT_MAX, filter, index)) return INVALID_STATION;
 	return index;
 }
 
@@ -192,6 +192,7 @@ template <class Tinst>
 void CargoList<Tinst>::Append(CargoPacket *cp)
 {
 	assert(cp != NULL);
+	static_cast<const Tinst *>(this)->ApplyPendingAge();
 	static_cast<Tinst *>(this)->AddToCache(cp);
 
 	for (List::reverse_iterator it(this->packets.rbegin()); it != this->packets.rend(); it++) {
@@ -206,6 +207,35 @@ void CargoList<Tinst>::Append(CargoPacket *cp)
 	this->packets.push_back(cp);
 }
 
+/**
+ * Adds part of a packet of another list to a packet in this list it can be
+ * merged with, without creating a packet for that part first. This has the
+ * same result as splitting the part off and appending it to this list, if
+ * the appended packet would have been merged.
+ * @param cp           Packet the part is taken from; it is not changed.
+ * @param count        Number of cargo entities in the part.
+ * @param feeder_share Feeder share of the part.
+ * @param loaded_at_xy Location the part is loaded at.
+ * @return True if the part was merged, false if it has to be appended as packet.
+ */
+template <class Tinst>
+bool CargoList<Tinst>::MergePart(const CargoPacket *cp, uint count, Money feeder_share, TileIndex loaded_at_xy)
+{
+	static_cast<const Tinst *>(this)->ApplyPendingAge();
+
+	for (List::reverse_iterator it(this->packets.rbegin()); it != this->packets.rend(); it++) {
+		CargoPacket *icp = *it;
+		if (Tinst::AreMergable(icp, cp, loaded_at_xy) && icp->count + count <= CargoPacket::MAX_COUNT) {
+			static_cast<Tinst *>(this)->RemoveFromCache(icp);
+			icp->count += count;
+			icp->feeder_share += feeder_share;
+			static_cast<Tinst *>(this)->AddToCache(icp);
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * Truncates the cargo in this list to the given amount. It leaves the
  * first count cargo entities and removes the rest.
@@ -214,16 +244,11 @@ void CargoList<Tinst>::Append(CargoPacket *cp)
 template <class Tinst>
 void CargoList<Tinst>::Truncate(uint max_remaining)
 {
-	for (Iterator it(packets.begin()); it != packets.end(); /* done during loop*/) {
-		CargoPacket *cp = *it;
-		if (max_remaining == 0) {
-			/* Nothing should remain, just remove the packets. */
-			it = this->packets.erase(it);
-			static_cast<Tinst *>(this)->RemoveFromCache(cp);
-			delete cp;
-			continue;
-		}
+	static_cast<const Tinst *>(this)->ApplyPendingAge();
 
+	Iterator it(this->packets.begin());
+	for (; it != this->packets.end() && max_remaining > 0; ++it) {
+		CargoPacket *cp = *it;
 		uint local_count = cp->count;
 		if (local_count > max_remaining) {
 			uint diff = local_count - max_remaining;
@@ -234,8 +259,15 @@ void CargoList<Tinst>::Truncate(uint max_remaining)
 		} else {
 			max_remaining -= local_count;
 		}
-		++it;
 	}
+
+	/* Nothing should remain of the other packets, so remove them all at once. */
+	for (Iterator del(it); del != this->packets.end(); ++del) {
+		CargoPacket *cp = *del;
+		static_cast<Tinst *>(this)->RemoveFromCache(cp);
+		delete cp;
+	}
+	this->packets.erase(it, this->packets.end());
 }
 
 /**
@@ -266,11 +298,17 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 	assert(mta == MTA_FINAL_DELIVERY || dest != NULL);
 	assert(mta == MTA_UNLOAD || mta == MTA_CARGO_LOAD || payment != NULL);
 
+	static_cast<const Tinst *>(this)->ApplyPendingAge();
+
+	/* Packets that are moved away completely are not erased one by one; the
+	 * skipped packets are shifted over them and the gap is erased at the end. */
+	Iterator kept(this->packets.begin());
 	Iterator it(this->packets.begin());
 	while (it != this->packets.end() && max_move > 0) {
 		CargoPacket *cp = *it;
 		if (cp->source == data && mta == MTA_FINAL_DELIVERY) {
 			/* Skip cargo that originated from this station. */
+			*kept++ = cp;
 			++it;
 			continue;
 		}
@@ -278,7 +316,7 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 		if (cp->count <= max_move) {
 			/* Can move the complete packet */
 			max_move -= cp->count;
-			it = this->packets.erase(it);
+			++it;
 			static_cast<Tinst *>(this)->RemoveFromCache(cp);
 			switch (mta) {
 				case MTA_FINAL_DELIVERY:
@@ -316,34 +354,50 @@ bool CargoList<Tinst>::MoveTo(Tother_inst *dest, uint max_move, MoveToAction mta
 			cp->feeder_share = 0;
 			cp->count = left;
 		} else {
-			/* But... the rest needs package splitting. */
-			CargoPacket *cp_new = cp->Split(max_move);
-
 			/* We could not allocate a CargoPacket? Is the map that full? */
-			if (cp_new == NULL) return false;
+			if (!CargoPacket::CanAllocateItem()) {
+				this->packets.erase(kept, it);
+				return false;
+			}
 
-			static_cast<Tinst *>(this)->RemoveFromCache(cp_new); // this reflects the changes in cp.
+			/* When the part fits into a packet of the destination, e.g. when loading
+			 * a wagon a bit further, add it there directly instead of splitting off
+			 * a packet only to merge it right away. */
+			Money fs = cp->feeder_share * max_move / static_cast<uint>(cp->count);
+			Money transfer = 0;
+			if (mta == MTA_TRANSFER) transfer = payment->PayTransfer(cp, max_move);
+			TileIndex loaded_at_xy = (mta == MTA_CARGO_LOAD) ? (TileIndex)data : cp->loaded_at_xy;
+
+			if (dest->MergePart(cp, max_move, fs + transfer, loaded_at_xy)) {
+				static_cast<Tinst *>(this)->RemoveFromCache(cp);
+				cp->feeder_share -= fs;
+				cp->count -= max_move;
+				static_cast<Tinst *>(this)->AddToCache(cp);
+			} else {
+				/* But... the rest needs package splitting. */
+				CargoPacket *cp_new = cp->Split(max_move);
+				static_cast<Tinst *>(this)->RemoveFromCache(cp_new); // this reflects the changes in cp.
 
-			if (mta == MTA_TRANSFER) {
 				/* Add the feeder share before inserting in dest. */
-				cp_new->feeder_share += payment->PayTransfer(cp_new, max_move);
-			} else if (mta == MTA_CARGO_LOAD) {
-				cp_new->loaded_at_xy = data;
+				cp_new->feeder_share += transfer;
+				cp_new->loaded_at_xy = loaded_at_xy;
+				dest->Append(cp_new);
 			}
-
-			dest->Append(cp_new);
 		}
 
 		max_move = 0;
 	}
 
-	return it != packets.end();
+	it = this->packets.erase(kept, it);
+	return it != this->packets.end();
 }
 
 /** Invalidates the cached data and rebuilds it. */
 template <class Tinst>
 void CargoList<Tinst>::InvalidateCache()
 {
+	static_cast<const Tinst *>(this)->ApplyPendingAge();
+
 	this->count = 0;
 	this->cargo_days_in_transit = 0;
 
@@ -375,18 +429,20 @@ void VehicleCargoList::AddToCache(const CargoPacket *cp)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Apply the aging that happened since the packets were last updated to all
+ * packets in this list. This has the same result as aging every packet each
+ * time #AgeCargo is called, but walks the packets only once.
  */
-void VehicleCargoList::AgeCargo()
+void VehicleCargoList::ApplyPendingAgeToPackets() const
 {
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		CargoPacket *cp = *it;
 		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
-
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+		uint age = minu(this->pending_age, 0xFF - cp->days_in_transit);
+		cp->days_in_transit += age;
+		this->cargo_days_in_transit += age * cp->count;
 	}
+	this->pending_age = 0;
 }
 
 /** Invalidates the cached data and rebuild it. */
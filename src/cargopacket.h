@@ -17,7 +17,7 @@
 #include "station_type.h"
 #include "cargo_type.h"
 #include "vehicle_type.h"
-#include <list>
+#include <deque>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -166,8 +166,8 @@ public:
 template <class Tinst>
 class CargoList {
 public:
-	/** Container with cargo packets. */
-	typedef std::list<CargoPacket *> List;
+	/** Container with cargo packets; a deque keeps the pointers in contiguous chunks. */
+	typedef std::deque<CargoPacket *> List;
 	/** The iterator for our container. */
 	typedef List::iterator Iterator;
 	/** The const iterator for our container. */
@@ -182,8 +182,8 @@ public:
 	};
 
 protected:
-	uint count;                 ///< Cache for the number of cargo entities.
-	uint cargo_days_in_transit; ///< Cache for the sum of number of days in transit of each entity; comparable to man-hours.
+	uint count;                         ///< Cache for the number of cargo entities.
+	mutable uint cargo_days_in_transit; ///< Cache for the sum of number of days in transit of each entity; comparable to man-hours. Mutable as vehicle lists apply their aging lazily.
 
 	List packets;               ///< The cargo packets in this list.
 
@@ -191,6 +191,9 @@ protected:
 
 	void RemoveFromCache(const CargoPacket *cp);
 
+	/** Lists that do not age their cargo have nothing to catch up on. */
+	inline void ApplyPendingAge() const {}
+
 public:
 	/** Create the cargo list. */
 	CargoList() {}
@@ -246,6 +249,7 @@ public:
 
 
 	void Append(CargoPacket *cp);
+	bool MergePart(const CargoPacket *cp, uint count, Money feeder_share, TileIndex loaded_at_xy);
 	void Truncate(uint max_remaining);
 
 	template <class Tother_inst>
@@ -262,7 +266,8 @@ protected:
 	/** The (direct) parent of this class. */
 	typedef CargoList<VehicleCargoList> Parent;
 
-	Money feeder_share; ///< Cache for the feeder share.
+	Money feeder_share;        ///< Cache for the feeder share.
+	mutable byte pending_age;  ///< Number of times the cargo aged since the packets were last updated; the packets' ages are relative to this.
 
 	void AddToCache(const CargoPacket *cp);
 	void RemoveFromCache(const CargoPacket *cp);
@@ -273,6 +278,29 @@ public:
 	/** The vehicles have a cargo list (and we want that saved). */
 	friend const struct SaveLoad *GetVehicleDescription(VehicleType vt);
 
+	/** Create the vehicle cargo list. */
+	VehicleCargoList() : pending_age(0) {}
+
+	/**
+	 * Returns a pointer to the cargo packet list with up to date ages.
+	 * @return Pointer to the packet list.
+	 */
+	inline const List *Packets() const
+	{
+		this->ApplyPendingAge();
+		return this->Parent::Packets();
+	}
+
+	/**
+	 * Returns average number of days in transit for a cargo entity.
+	 * @return The before mentioned number.
+	 */
+	inline uint DaysInTransit() const
+	{
+		this->ApplyPendingAge();
+		return this->Parent::DaysInTransit();
+	}
+
 	/**
 	 * Returns total sum of the feeder share for all packets.
 	 * @return The before mentioned number.
@@ -282,7 +310,26 @@ public:
 		return this->feeder_share;
 	}
 
-	void AgeCargo();
+	/**
+	 * Ages all cargo in this list. The packets themselves are only updated
+	 * when they are looked at, see #ApplyPendingAge.
+	 */
+	inline void AgeCargo()
+	{
+		/* Cargo loaded later must not age, so there is nothing to remember for an empty list.
+		 * Once 0xFF is pending every packet will be at the maximum anyway. */
+		if (!this->packets.empty() && this->pending_age != 0xFF) this->pending_age++;
+	}
+
+	/**
+	 * Bring the ages of the packets, and the cache of the days in transit, up to date.
+	 */
+	inline void ApplyPendingAge() const
+	{
+		if (this->pending_age != 0) this->ApplyPendingAgeToPackets();
+	}
+
+	void ApplyPendingAgeToPackets() const;
 
 	void InvalidateCache();
 
@@ -294,12 +341,26 @@ public:
 	 * @return True if they are mergeable.
 	 */
 	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2)
+	{
+		return AreMergable(cp1, cp2, cp2->loaded_at_xy);
+	}
+
+	/**
+	 * Are two the two CargoPackets mergeable in the context of
+	 * a list of CargoPackets for a Vehicle, when the second one
+	 * would be loaded at the given location?
+	 * @param cp1 First CargoPacket.
+	 * @param cp2 Second CargoPacket.
+	 * @param loaded_at_xy Location the second packet would be loaded at.
+	 * @return True if they are mergeable.
+	 */
+	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2, TileIndex loaded_at_xy)
 	{
 		return cp1->source_xy    == cp2->source_xy &&
 				cp1->days_in_transit == cp2->days_in_transit &&
 				cp1->source_type     == cp2->source_type &&
 				cp1->source_id       == cp2->source_id &&
-				cp1->loaded_at_xy    == cp2->loaded_at_xy;
+				cp1->loaded_at_xy    == loaded_at_xy;
 	}
 };
 
@@ -327,6 +388,20 @@ public:
 				cp1->source_type     == cp2->source_type &&
 				cp1->source_id       == cp2->source_id;
 	}
+
+	/**
+	 * Are two the two CargoPackets mergeable in the context of
+	 * a list of CargoPackets for a Station? Where the cargo was
+	 * loaded does not matter for stations.
+	 * @param cp1 First CargoPacket.
+	 * @param cp2 Second CargoPacket.
+	 * @param loaded_at_xy Location the second packet would be loaded at.
+	 * @return True if they are mergeable.
+	 */
+	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2, TileIndex loaded_at_xy)
+	{
+		return AreMergable(cp1, cp2);
+	}
 };
 
 #endif /* CARGOPACKET_H */
@@ -26,6 +26,7 @@
 #include "signal_func.h"
 #include "core/backup_type.hpp"
 #include "object_base.h"
+#include "newgrf_engine.h"
 
 #include "table/strings.h"
 
@@ -598,6 +599,9 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd,
 	assert(_docommand_recursive == 0);
 	_docommand_recursive = 1;
 
+	/* Do not let the command use callback results remembered outside of the game loop. */
+	InvalidateVehicleCallbackCaches();
+
 	/* Reset the state. */
 	_additional_cash_required = 0;
 
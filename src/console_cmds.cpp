@@ -38,6 +38,12 @@
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "pathfinder/yapf/yapf_recorder.h"
+#include "spritecache.h"
+#include "gfx_layout_cache.h"
+#include "newgrf_engine.h"
+#include "newgrf_profiling.h"
+#include "tgp.h"
 #include "table/strings.h"
 
 /* scriptfile handling */
@@ -1430,6 +1436,188 @@ DEF_CONSOLE_CMD(ConDebugLevel)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConPathfinderRecord)
+{
+	if (argc == 0) {
+		IConsoleHelp("Record all YAPF track choice queries to a file. Usage: 'pf_record <filename> | stop'");
+		return true;
+	}
+
+	if (argc != 2) return false;
+
+	if (strcmp(argv[1], "stop") == 0) {
+		if (!YapfIsRecording()) {
+			IConsoleWarning("No pathfinder recording running.");
+		} else {
+			YapfStopRecording();
+			IConsolePrintF(CC_DEFAULT, "Pathfinder recording stopped.");
+		}
+		return true;
+	}
+
+	if (YapfStartRecording(argv[1])) {
+		IConsolePrintF(CC_DEFAULT, "Pathfinder queries are recorded to: %s", argv[1]);
+	} else {
+		IConsoleError("could not open file");
+	}
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConPathfinderReplay)
+{
+	if (argc == 0) {
+		IConsoleHelp("Replay recorded YAPF track choice queries on the current game and report their cost. Usage: 'pf_replay <filename> [<result filename>]'");
+		IConsoleHelp("Load the savegame the recording was started from first. The results of the replayed queries are written to the result file, if given, to compare builds.");
+		IConsoleHelp("Paths are not reserved while replaying, so the game is not changed.");
+		return true;
+	}
+
+	if (argc < 2 || argc > 3) return false;
+
+	YapfReplayQueries(argv[1], argc == 3 ? argv[2] : NULL);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConSpriteCache)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the usage of the sprite cache. Usage: 'sprite_cache [reset]'");
+		IConsoleHelp("With 'reset' the hit, miss, eviction and prefetch counters are reset.");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "reset") != 0) return false;
+		ResetSpriteCacheStats();
+		IConsolePrint(CC_DEFAULT, "Sprite cache counters reset.");
+		return true;
+	}
+
+	const SpriteCacheStats &stats = GetSpriteCacheStats();
+	uint64 requests = stats.hits + stats.misses;
+	IConsolePrintF(CC_DEFAULT, "Hits:       " OTTD_PRINTF64 " (%u%%)", stats.hits, requests == 0 ? 0 : (uint)(stats.hits * 100 / requests));
+	IConsolePrintF(CC_DEFAULT, "Misses:     " OTTD_PRINTF64, stats.misses);
+	IConsolePrintF(CC_DEFAULT, "Evictions:  " OTTD_PRINTF64, stats.evictions);
+	IConsolePrintF(CC_DEFAULT, "Prefetched: " OTTD_PRINTF64, stats.prefetches);
+	IConsolePrintF(CC_DEFAULT, "In use:     %u KiB of %u KiB allocated", (uint)(stats.used / 1024), (uint)(stats.reserved / 1024));
+	IConsolePrintF(CC_DEFAULT, "Budget:     %u KiB, may grow to %u KiB", (uint)(stats.budget / 1024), (uint)(stats.ceiling / 1024));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConLayoutCache)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the usage of the cache of measured string layouts. Usage: 'layout_cache [reset]'");
+		IConsoleHelp("With 'reset' the hit, miss and eviction counters are reset.");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "reset") != 0) return false;
+		ResetLayoutCacheStats();
+		IConsolePrint(CC_DEFAULT, "Layout cache counters reset.");
+		return true;
+	}
+
+	const LayoutCacheStats &stats = GetLayoutCacheStats();
+	uint64 requests = stats.hits + stats.misses;
+	IConsolePrintF(CC_DEFAULT, "Hits:      " OTTD_PRINTF64 " (%u%%)", stats.hits, requests == 0 ? 0 : (uint)(stats.hits * 100 / requests));
+	IConsolePrintF(CC_DEFAULT, "Misses:    " OTTD_PRINTF64, stats.misses);
+	IConsolePrintF(CC_DEFAULT, "Evictions: " OTTD_PRINTF64, stats.evictions);
+	IConsolePrintF(CC_DEFAULT, "In use:    %u layouts, %u KiB", stats.entries, (uint)(stats.used / 1024));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConNewGRFBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Resolve the sprites and some callbacks of all NewGRF vehicles and report the time it took. Usage: 'newgrf_bench [<iterations>]'");
+		IConsoleHelp("The checksum of the results only changes when the vehicles resolve to something else.");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint32 iterations = 100;
+	if (argc == 2 && (!GetArgumentInteger(&iterations, argv[1]) || iterations == 0)) return false;
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleError("There are only vehicles to resolve in a game.");
+		return true;
+	}
+
+	uint resolves;
+	RealTimeTimer timer;
+	timer.Start();
+	uint32 checksum = BenchmarkVehicleResolving(iterations, &resolves);
+	timer.Stop();
+
+	uint us = (uint)timer.GetMicroseconds();
+	IConsolePrintF(CC_DEFAULT, "Resolved %u chains in %u us (%.3f us each), checksum %08X", resolves, us, resolves == 0 ? 0.0 : (double)timer.acc / 1000 / resolves, checksum);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConNewGRFProfile)
+{
+	if (argc == 0) {
+		IConsoleHelp("Measure the time spent resolving the action 2 chains of each NewGRF and callback. Usage: 'newgrf_profile start | stop | report [<count>]'");
+		IConsoleHelp("'start' discards the previous profile, 'report' shows the <count> most expensive chains, 20 by default.");
+		return true;
+	}
+
+	if (argc < 2 || argc > 3) return false;
+
+	if (strcmp(argv[1], "start") == 0 && argc == 2) {
+		StartNewGRFProfiling();
+		IConsolePrint(CC_DEFAULT, "NewGRF profiling started.");
+		return true;
+	}
+
+	if (strcmp(argv[1], "stop") == 0 && argc == 2) {
+		StopNewGRFProfiling();
+		IConsolePrint(CC_DEFAULT, "NewGRF profiling stopped.");
+		return true;
+	}
+
+	if (strcmp(argv[1], "report") == 0) {
+		uint32 count = 20;
+		if (argc == 3 && !GetArgumentInteger(&count, argv[2])) return false;
+		PrintNewGRFProfile(count);
+		return true;
+	}
+
+	return false;
+}
+
+DEF_CONSOLE_CMD(ConTerrainBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Generate height maps of all square map sizes up to the given size with the TerraGenesis generator and report the time it took. Usage: 'tgp_bench [<size> [<seed>]]'");
+		IConsoleHelp("The checksums of the height maps only change when the generator produces different terrain.");
+		return true;
+	}
+
+	if (argc > 3) return false;
+
+	uint32 max_size = 1024;
+	uint32 seed = 1;
+	if (argc >= 2 && (!GetArgumentInteger(&max_size, argv[1]) || max_size < MIN_MAP_SIZE || max_size > MAX_MAP_SIZE)) return false;
+	if (argc == 3 && !GetArgumentInteger(&seed, argv[2])) return false;
+
+	for (uint size = MIN_MAP_SIZE; size <= max_size; size *= 2) {
+		RealTimeTimer timer;
+		timer.Start();
+		uint32 checksum = BenchmarkTerrainPerlin(size, size, seed);
+		timer.Stop();
+		IConsolePrintF(CC_DEFAULT, "%4ux%-4u %8u us, checksum %08X", size, size, (uint)timer.GetMicroseconds(), checksum);
+	}
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConExit)
 {
 	if (argc == 0) {
@@ -1888,6 +2076,13 @@ static void IConsoleDebugLibRegister()
 void IConsoleStdLibRegister()
 {
 	IConsoleCmdRegister("debug_level",  ConDebugLevel);
+	IConsoleCmdRegister("pf_record",    ConPathfinderRecord);
+	IConsoleCmdRegister("pf_replay",    ConPathfinderReplay);
+	IConsoleCmdRegister("sprite_cache", ConSpriteCache);
+	IConsoleCmdRegister("layout_cache", ConLayoutCache);
+	IConsoleCmdRegister("newgrf_bench", ConNewGRFBenchmark);
+	IConsoleCmdRegister("newgrf_profile", ConNewGRFProfile);
+	IConsoleCmdRegister("tgp_bench",    ConTerrainBenchmark);
 	IConsoleCmdRegister("echo",         ConEcho);
 	IConsoleCmdRegister("echoc",        ConEchoC);
 	IConsoleCmdRegister("exec",         ConExec);
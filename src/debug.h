@@ -71,6 +71,50 @@ const char *GetDebugString();
  */
 uint64 ottd_rdtsc();
 
+/**
+ * Get the time of a real time clock; monotonic where the OS has one.
+ * @return The time in nanoseconds since some arbitrary moment.
+ */
+uint64 ottd_nanoseconds();
+
+/** Adds up the real time spent between calls to Start and Stop. */
+struct RealTimeTimer {
+	uint64 start; ///< When the timer was last started, in nanoseconds.
+	uint64 acc;   ///< The time added up so far, in nanoseconds.
+
+	RealTimeTimer() : start(0), acc(0) {}
+
+	/** Start measuring. */
+	inline void Start()
+	{
+		this->start = ottd_nanoseconds();
+	}
+
+	/** Stop measuring, and add the time since #Start. */
+	inline void Stop()
+	{
+		this->acc += ottd_nanoseconds() - this->start;
+	}
+
+	/**
+	 * Get the time added up so far.
+	 * @return The time in microseconds.
+	 */
+	inline uint64 GetMicroseconds() const
+	{
+		return this->acc / 1000;
+	}
+
+	/**
+	 * Get the time added up so far.
+	 * @return The time in milliseconds.
+	 */
+	inline uint GetMilliseconds() const
+	{
+		return (uint)(this->acc / 1000000);
+	}
+};
+
 /* Used for profiling
  *
  * Usage:
@@ -17,11 +17,21 @@
 #include "core/pool_func.hpp"
 #include "vehicle_gui.h"
 #include "vehiclelist.h"
+#include "spatial_index.h"
 
 /** All our depots tucked away in a pool. */
 DepotPool _depot_pool("Depot");
 INSTANTIATE_POOL_METHODS(Depot)
 
+/**
+ * Create a new depot.
+ * @param xy The tile of the depot.
+ */
+Depot::Depot(TileIndex xy) : xy(xy)
+{
+	if (xy != INVALID_TILE) _depot_spatial_index.Add(this->index, xy);
+}
+
 /**
  * Clean up a depot
  */
@@ -29,6 +39,8 @@ Depot::~Depot()
 {
 	if (CleaningPool()) return;
 
+	_depot_spatial_index.Remove(this->index, this->xy);
+
 	if (!IsDepotTile(this->xy) || GetDepotIndex(this->xy) != this->index) {
 		/* It can happen there is no depot here anymore (TTO/TTD savegames) */
 		return;
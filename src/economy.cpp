@@ -45,6 +45,7 @@
 #include "water.h"
 #include "game/game.hpp"
 #include "cargomonitor.h"
+#include "performance_counters.h"
 
 #include "table/strings.h"
 #include "table/pricebase.h"
@@ -1055,6 +1056,7 @@ static Money DeliverGoods(int num_pieces, CargoID cargo_type, StationID dest, Ti
 
 	/* Update company statistics */
 	company->cur_economy.delivered_cargo[cargo_type] += accepted;
+	_performance_counters.cargo_delivered += accepted;
 
 	/* Increase town's counter for town effects */
 	const CargoSpec *cs = CargoSpec::Get(cargo_type);
@@ -1294,6 +1296,28 @@ static void LoadUnloadVehicle(Vehicle *front, int *cargo_left)
 
 	CargoPayment *payment = front->cargo_payment;
 
+	/* The statistics of the goods picked up are the same for all parts of the consist. */
+	int t;
+	switch (front->type) {
+		case VEH_TRAIN: /* FALL THROUGH */
+		case VEH_SHIP:
+			t = front->vcache.cached_max_speed;
+			break;
+
+		case VEH_ROAD:
+			t = front->vcache.cached_max_speed / 2;
+			break;
+
+		case VEH_AIRCRAFT:
+			t = Aircraft::From(front)->GetSpeedOldUnits(); // Convert to old units.
+			break;
+
+		default: NOT_REACHED();
+	}
+	/* if last speed is 0, we treat that as if no vehicle has ever visited the station. */
+	const byte last_speed = min(t, 255);
+	const byte last_age = min(_cur_year - front->build_year, 255);
+
 	uint artic_part = 0; // Articulated part we are currently trying to load. (not counting parts without capacity)
 	for (Vehicle *v = front; v != NULL; v = v->Next()) {
 		if (v == front || !v->Previous()->HasArticulatedPart()) artic_part = 0;
@@ -1451,27 +1475,8 @@ static void LoadUnloadVehicle(Vehicle *front, int *cargo_left)
 		}
 
 		/* update stats */
-		int t;
-		switch (front->type) {
-			case VEH_TRAIN: /* FALL THROUGH */
-			case VEH_SHIP:
-				t = front->vcache.cached_max_speed;
-				break;
-
-			case VEH_ROAD:
-				t = front->vcache.cached_max_speed / 2;
-				break;
-
-			case VEH_AIRCRAFT:
-				t = Aircraft::From(front)->GetSpeedOldUnits(); // Convert to old units.
-				break;
-
-			default: NOT_REACHED();
-		}
-
-		/* if last speed is 0, we treat that as if no vehicle has ever visited the station. */
-		ge->last_speed = min(t, 255);
-		ge->last_age = min(_cur_year - front->build_year, 255);
+		ge->last_speed = last_speed;
+		ge->last_age = last_age;
 		ge->time_since_pickup = 0;
 
 		/* If there's goods waiting at the station, and the vehicle
@@ -1641,6 +1646,9 @@ static void LoadUnloadVehicle(Vehicle *front, int *cargo_left)
 	}
 
 	if (dirty_vehicle) {
+		/* Callbacks may depend on the cargo that was just moved. */
+		for (Vehicle *v = front; v != NULL; v = v->Next()) v->InvalidateNewGRFCallbackCache();
+
 		SetWindowDirty(GetWindowClassForVehicleType(front->type), front->owner);
 		SetWindowDirty(WC_VEHICLE_DETAILS, front->index);
 		front->MarkDirty();
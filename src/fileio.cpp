@@ -28,6 +28,12 @@
 #include <sys/stat.h>
 #include <algorithm>
 
+#if defined(UNIX) && !defined(__MORPHOS__) && !defined(__AMIGA__) && !defined(__OS2__)
+/** Slotted files are memory mapped when possible. */
+#	define WITH_FIO_MMAP
+#	include <sys/mman.h>
+#endif
+
 /** Size of the #Fio data buffer. */
 #define FIO_BUFFER_SIZE 512
 
@@ -36,8 +42,12 @@ struct Fio {
 	byte *buffer, *buffer_end;             ///< position pointer in local buffer and last valid byte of buffer
 	size_t pos;                            ///< current (system) position in file
 	FILE *cur_fh;                          ///< current file handle
+	const byte *cur_map;                   ///< memory mapping of the current file, or \c NULL when reading through #buffer_start
+	size_t cur_map_size;                   ///< size of #cur_map
 	const char *filename;                  ///< current filename
 	FILE *handles[MAX_FILE_SLOTS];         ///< array of file handles we can have open
+	const byte *maps[MAX_FILE_SLOTS];      ///< memory mappings of the opened files, \c NULL for files that are read buffered
+	size_t map_sizes[MAX_FILE_SLOTS];      ///< sizes of the memory mappings
 	byte buffer_start[FIO_BUFFER_SIZE];    ///< local buffer when read from file
 	const char *filenames[MAX_FILE_SLOTS]; ///< array of filenames we (should) have open
 	char *shortnames[MAX_FILE_SLOTS];      ///< array of short names for spriteloader's use
@@ -61,6 +71,7 @@ extern char *_highscore_file;
  */
 size_t FioGetPos()
 {
+	if (_fio.cur_map != NULL) return _fio.pos;
 	return _fio.pos + (_fio.buffer - _fio.buffer_end);
 }
 
@@ -74,6 +85,25 @@ const char *FioGetFilename(uint8 slot)
 	return _fio.shortnames[slot];
 }
 
+/**
+ * Get the size of the file, or the tar containing it, that is opened in a slot.
+ * @param slot The slot of the file.
+ * @return The size of the file.
+ */
+size_t FioGetFileSize(uint8 slot)
+{
+	if (_fio.maps[slot] != NULL) return _fio.map_sizes[slot];
+
+	FILE *f = _fio.handles[slot];
+	if (f == NULL) return 0;
+
+	long pos = ftell(f);
+	fseek(f, 0, SEEK_END);
+	size_t size = ftell(f);
+	fseek(f, pos, SEEK_SET);
+	return size;
+}
+
 /**
  * Seek in the current file.
  * @param pos New position.
@@ -84,7 +114,7 @@ void FioSeekTo(size_t pos, int mode)
 	if (mode == SEEK_CUR) pos += FioGetPos();
 	_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
 	_fio.pos = pos;
-	fseek(_fio.cur_fh, _fio.pos, SEEK_SET);
+	if (_fio.cur_map == NULL) fseek(_fio.cur_fh, _fio.pos, SEEK_SET);
 }
 
 #if defined(LIMITED_FDS)
@@ -114,6 +144,8 @@ void FioSeekToFile(uint8 slot, size_t pos)
 	f = _fio.handles[slot];
 	assert(f != NULL);
 	_fio.cur_fh = f;
+	_fio.cur_map = _fio.maps[slot];
+	_fio.cur_map_size = _fio.map_sizes[slot];
 	_fio.filename = _fio.filenames[slot];
 	FioSeekTo(pos, SEEK_SET);
 }
@@ -124,6 +156,11 @@ void FioSeekToFile(uint8 slot, size_t pos)
  */
 byte FioReadByte()
 {
+	if (_fio.cur_map != NULL) {
+		if (_fio.pos >= _fio.cur_map_size) return 0;
+		return _fio.cur_map[_fio.pos++];
+	}
+
 	if (_fio.buffer == _fio.buffer_end) {
 		_fio.buffer = _fio.buffer_start;
 		size_t size = fread(_fio.buffer, 1, FIO_BUFFER_SIZE, _fio.cur_fh);
@@ -141,6 +178,11 @@ byte FioReadByte()
  */
 void FioSkipBytes(int n)
 {
+	if (_fio.cur_map != NULL) {
+		_fio.pos = max(_fio.pos, min(_fio.pos + n, _fio.cur_map_size));
+		return;
+	}
+
 	for (;;) {
 		int m = min(_fio.buffer_end - _fio.buffer, n);
 		_fio.buffer += m;
@@ -157,6 +199,12 @@ void FioSkipBytes(int n)
  */
 uint16 FioReadWord()
 {
+	if (_fio.cur_map != NULL && _fio.pos + 2 <= _fio.cur_map_size) {
+		const byte *p = _fio.cur_map + _fio.pos;
+		_fio.pos += 2;
+		return p[0] | (p[1] << 8);
+	}
+
 	byte b = FioReadByte();
 	return (FioReadByte() << 8) | b;
 }
@@ -178,10 +226,66 @@ uint32 FioReadDword()
  */
 void FioReadBlock(void *ptr, size_t size)
 {
+	if (_fio.cur_map != NULL) {
+		if (_fio.pos >= _fio.cur_map_size) return;
+		size = min(size, _fio.cur_map_size - _fio.pos);
+		memcpy(ptr, _fio.cur_map + _fio.pos, size);
+		_fio.pos += size;
+		return;
+	}
+
 	FioSeekTo(FioGetPos(), SEEK_SET);
 	_fio.pos += fread(ptr, 1, size, _fio.cur_fh);
 }
 
+/**
+ * Get direct access to the data of the current file, when it is memory mapped.
+ * The data stays valid until the file is closed. The position in the file is not changed.
+ * @param[out] available Number of bytes that can be read from the returned pointer.
+ * @return The data at the current position, or \c NULL when the file is read buffered.
+ */
+const byte *FioGetMappedData(size_t *available)
+{
+	if (_fio.cur_map == NULL) return NULL;
+
+	*available = _fio.pos < _fio.cur_map_size ? _fio.cur_map_size - _fio.pos : 0;
+	return _fio.cur_map + min(_fio.pos, _fio.cur_map_size);
+}
+
+/**
+ * Try to memory map the whole file behind a file handle.
+ * @param f The file to map.
+ * @param[out] size The size of the mapping.
+ * @return The mapped data, or \c NULL if the file could not be mapped and has to be read buffered.
+ */
+const byte *FioMapFile(FILE *f, size_t *size)
+{
+#if defined(WITH_FIO_MMAP)
+	struct stat st;
+	if (fstat(fileno(f), &st) != 0 || st.st_size <= 0 || (uint64)st.st_size > SIZE_MAX) return NULL;
+
+	void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (map == MAP_FAILED) return NULL;
+
+	*size = (size_t)st.st_size;
+	return (const byte *)map;
+#else
+	return NULL;
+#endif /* WITH_FIO_MMAP */
+}
+
+/**
+ * Remove a memory mapping made by #FioMapFile.
+ * @param map The mapped data.
+ * @param size The size of the mapping.
+ */
+void FioUnmapFile(const byte *map, size_t size)
+{
+#if defined(WITH_FIO_MMAP)
+	if (map != NULL) munmap(const_cast<byte *>(map), size);
+#endif /* WITH_FIO_MMAP */
+}
+
 /**
  * Close the file at the given slot number.
  * @param slot File index to close.
@@ -189,6 +293,9 @@ void FioReadBlock(void *ptr, size_t size)
 static inline void FioCloseFile(int slot)
 {
 	if (_fio.handles[slot] != NULL) {
+		FioUnmapFile(_fio.maps[slot], _fio.map_sizes[slot]);
+		if (_fio.cur_map == _fio.maps[slot]) _fio.cur_map = NULL;
+		_fio.maps[slot] = NULL;
 		fclose(_fio.handles[slot]);
 
 		free(_fio.shortnames[slot]);
@@ -252,6 +359,7 @@ void FioOpenFile(int slot, const char *filename, Subdirectory subdir)
 
 	FioCloseFile(slot); // if file was opened before, close it
 	_fio.handles[slot] = f;
+	_fio.maps[slot] = FioMapFile(f, &_fio.map_sizes[slot]);
 	_fio.filenames[slot] = filename;
 
 	/* Store the filename without path and extension */
@@ -527,7 +635,7 @@ FILE *FioFOpenFile(const char *filename, const char *mode, Subdirectory subdir,
  * Create a directory with the given name
  * @param name the new name of the directory
  */
-static void FioCreateDirectory(const char *name)
+void FioCreateDirectory(const char *name)
 {
 #if defined(WIN32) || defined(WINCE)
 	CreateDirectory(OTTD2FS(name), NULL);
@@ -1196,6 +1304,8 @@ void DeterminePaths(const char *exe)
 	_highscore_file = str_fmt("%shs.dat", _personal_dir);
 	extern char *_hotkeys_file;
 	_hotkeys_file = str_fmt("%shotkeys.cfg",  _personal_dir);
+	extern char *_newgrf_cache_file;
+	_newgrf_cache_file = str_fmt("%snewgrf_cache.dat", _personal_dir);
 
 	/* Make the necessary folders */
 #if !defined(__MORPHOS__) && !defined(__AMIGA__) && defined(WITH_PERSONAL_DIR)
@@ -19,6 +19,7 @@ void FioSeekTo(size_t pos, int mode);
 void FioSeekToFile(uint8 slot, size_t pos);
 size_t FioGetPos();
 const char *FioGetFilename(uint8 slot);
+size_t FioGetFileSize(uint8 slot);
 byte FioReadByte();
 uint16 FioReadWord();
 uint32 FioReadDword();
@@ -26,6 +27,9 @@ void FioCloseAll();
 void FioOpenFile(int slot, const char *filename, Subdirectory subdir);
 void FioReadBlock(void *ptr, size_t size);
 void FioSkipBytes(int n);
+const byte *FioGetMappedData(size_t *available);
+const byte *FioMapFile(FILE *f, size_t *size);
+void FioUnmapFile(const byte *map, size_t size);
 
 /**
  * The search paths OpenTTD could search through.
@@ -63,6 +67,7 @@ bool AppendPathSeparator(char *buf, size_t buflen);
 void DeterminePaths(const char *exe);
 void *ReadFileToMem(const char *filename, size_t *lenp, size_t maxsize);
 bool FileExists(const char *filename);
+void FioCreateDirectory(const char *name);
 const char *FioTarFirstDir(const char *tarname, Subdirectory subdir);
 void FioTarAddLink(const char *src, const char *dest, Subdirectory subdir);
 bool ExtractTar(const char *tar_filename, Subdirectory subdir);
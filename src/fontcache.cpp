@@ -15,6 +15,7 @@
 #include "core/math_func.hpp"
 #include "strings_func.h"
 #include "zoom_type.h"
+#include "core/smallvec_type.hpp"
 
 #include "table/sprites.h"
 #include "table/control_codes.h"
@@ -998,7 +999,6 @@ static FT_Face GetFontFace(FontSize size)
 struct GlyphEntry {
 	Sprite *sprite;
 	byte width;
-	bool duplicate;
 };
 
 
@@ -1016,6 +1016,50 @@ struct GlyphEntry {
  */
 static GlyphEntry **_glyph_ptr[FS_END];
 
+/** Marker in #_glyph_widths for characters of which the width is not known yet. */
+static const byte GLYPH_WIDTH_UNKNOWN = 0xFF;
+
+/**
+ * The widths of the glyphs of characters in the basic multilingual plane, so
+ * text can be measured without rendering the glyphs or walking #_glyph_ptr.
+ * It is filled on demand, when a character is measured or rendered; characters
+ * that have not been yet are #GLYPH_WIDTH_UNKNOWN.
+ */
+static byte *_glyph_widths[FS_END];
+
+/**
+ * A page of the glyph atlas. The rendered glyphs of a font size are packed
+ * into a few large pages instead of each getting its own allocation, so they
+ * are close together in memory and can all be freed at once.
+ */
+struct GlyphAtlasPage {
+	GlyphAtlasPage *next; ///< The page that was filled before this one.
+	size_t size;          ///< Bytes available for glyphs in this page.
+	size_t used;          ///< Bytes taken by glyphs in this page.
+
+	/**
+	 * Get the start of the glyphs in the page.
+	 * @return The first byte after the header.
+	 */
+	inline byte *GetData()
+	{
+		return (byte *)(this + 1);
+	}
+};
+
+/** Bytes available for glyphs in a normal page of the glyph atlas. */
+static const size_t GLYPH_ATLAS_PAGE_SIZE = 64 * 1024 - sizeof(GlyphAtlasPage);
+
+static GlyphAtlasPage *_glyph_atlas[FS_END]; ///< The pages of the glyph atlas of each font size, the one being filled first.
+static FontSize _glyph_atlas_size;           ///< The font size of which glyphs are currently allocated by #AllocateFont.
+
+/** Maximum number of glyphs rendered by one call to #ProcessGlyphPrefetchQueue. */
+static const uint MAX_GLYPH_PREFETCH_PER_LOOP = 16;
+
+static SmallVector<uint32, 256> _glyph_prefetch;         ///< Font size and character of the glyphs to render ahead of drawing.
+static uint _glyph_prefetch_pos;                         ///< Position in #_glyph_prefetch of the next glyph to render.
+static byte _glyph_prefetch_queued[FS_END][0x10000 / 8]; ///< Bitmap of the characters that are in #_glyph_prefetch.
+
 /**
  * Clear the complete cache
  * @param monospace Whether to reset the monospace or regular font.
@@ -1024,22 +1068,26 @@ static void ResetGlyphCache(bool monospace)
 {
 	for (FontSize i = FS_BEGIN; i < FS_END; i++) {
 		if (monospace != (i == FS_MONO)) continue;
-		if (_glyph_ptr[i] == NULL) continue;
 
-		for (int j = 0; j < 256; j++) {
-			if (_glyph_ptr[i][j] == NULL) continue;
+		while (_glyph_atlas[i] != NULL) {
+			GlyphAtlasPage *page = _glyph_atlas[i];
+			_glyph_atlas[i] = page->next;
+			free(page);
+		}
 
-			for (int k = 0; k < 256; k++) {
-				if (_glyph_ptr[i][j][k].duplicate) continue;
-				free(_glyph_ptr[i][j][k].sprite);
-			}
+		free(_glyph_widths[i]);
+		_glyph_widths[i] = NULL;
 
-			free(_glyph_ptr[i][j]);
-		}
+		if (_glyph_ptr[i] == NULL) continue;
+
+		for (int j = 0; j < 256; j++) free(_glyph_ptr[i][j]);
 
 		free(_glyph_ptr[i]);
 		_glyph_ptr[i] = NULL;
 	}
+
+	/* Render the glyphs of the language again with the new font. */
+	_glyph_prefetch_pos = 0;
 }
 
 static GlyphEntry *GetGlyphPtr(FontSize size, WChar key)
@@ -1049,8 +1097,24 @@ static GlyphEntry *GetGlyphPtr(FontSize size, WChar key)
 	return &_glyph_ptr[size][GB(key, 8, 8)][GB(key, 0, 8)];
 }
 
+/**
+ * Remember the width of the glyph of a character.
+ * @param size The font size.
+ * @param key The character.
+ * @param width The width of its glyph.
+ */
+static void SetGlyphWidth(FontSize size, WChar key, byte width)
+{
+	if (key > 0xFFFF) return;
+
+	if (_glyph_widths[size] == NULL) {
+		_glyph_widths[size] = MallocT<byte>(0x10000);
+		memset(_glyph_widths[size], GLYPH_WIDTH_UNKNOWN, 0x10000);
+	}
+	_glyph_widths[size][key] = width;
+}
 
-static void SetGlyphPtr(FontSize size, WChar key, const GlyphEntry *glyph, bool duplicate = false)
+static void SetGlyphPtr(FontSize size, WChar key, const GlyphEntry *glyph)
 {
 	if (_glyph_ptr[size] == NULL) {
 		DEBUG(freetype, 3, "Allocating root glyph cache for size %u", size);
@@ -1065,12 +1129,34 @@ static void SetGlyphPtr(FontSize size, WChar key, const GlyphEntry *glyph, bool
 	DEBUG(freetype, 4, "Set glyph for unicode character 0x%04X, size %u", key, size);
 	_glyph_ptr[size][GB(key, 8, 8)][GB(key, 0, 8)].sprite    = glyph->sprite;
 	_glyph_ptr[size][GB(key, 8, 8)][GB(key, 0, 8)].width     = glyph->width;
-	_glyph_ptr[size][GB(key, 8, 8)][GB(key, 0, 8)].duplicate = duplicate;
+	SetGlyphWidth(size, key, glyph->width);
 }
 
+/**
+ * Allocate memory for a glyph in the glyph atlas of #_glyph_atlas_size.
+ * @param size The number of bytes to allocate.
+ * @return The allocated memory.
+ */
 static void *AllocateFont(size_t size)
 {
-	return MallocT<byte>(size);
+	size = Align(size, sizeof(void *));
+
+	GlyphAtlasPage *page = _glyph_atlas[_glyph_atlas_size];
+	if (page == NULL || page->used + size > page->size) {
+		/* Glyphs that are bigger than a page get a page of their own. */
+		size_t page_size = max(size, GLYPH_ATLAS_PAGE_SIZE);
+		DEBUG(freetype, 3, "Allocating glyph atlas page of %u bytes for size %u", (uint)page_size, _glyph_atlas_size);
+
+		page = (GlyphAtlasPage *)MallocT<byte>(sizeof(GlyphAtlasPage) + page_size);
+		page->next = _glyph_atlas[_glyph_atlas_size];
+		page->size = page_size;
+		page->used = 0;
+		_glyph_atlas[_glyph_atlas_size] = page;
+	}
+
+	void *ptr = page->GetData() + page->used;
+	page->used += size;
+	return ptr;
 }
 
 
@@ -1132,17 +1218,18 @@ const Sprite *GetGlyph(FontSize size, WChar key)
 		if (key == '?') {
 			/* The font misses the '?' character. Use sprite font. */
 			SpriteID sprite = GetUnicodeGlyph(size, key);
+			_glyph_atlas_size = size;
 			Sprite *spr = (Sprite*)GetRawSprite(sprite, ST_FONT, AllocateFont);
 			assert(spr != NULL);
 			new_glyph.sprite = spr;
 			new_glyph.width  = spr->width + (size != FS_NORMAL);
-			SetGlyphPtr(size, key, &new_glyph, false);
+			SetGlyphPtr(size, key, &new_glyph);
 			return new_glyph.sprite;
 		} else {
 			/* Use '?' for missing characters. */
 			GetGlyph(size, '?');
 			glyph = GetGlyphPtr(size, '?');
-			SetGlyphPtr(size, key, glyph, true);
+			SetGlyphPtr(size, key, glyph);
 			return glyph->sprite;
 		}
 	}
@@ -1188,6 +1275,7 @@ const Sprite *GetGlyph(FontSize size, WChar key)
 		}
 	}
 
+	_glyph_atlas_size = size;
 	new_glyph.sprite = BlitterFactoryBase::GetCurrentBlitter()->Encode(&sprite, AllocateFont);
 	new_glyph.width  = slot->advance.x >> 6;
 
@@ -1214,15 +1302,80 @@ uint GetGlyphWidth(FontSize size, WChar key)
 		return SpriteExists(sprite) ? GetSprite(sprite, ST_FONT)->width + (size != FS_NORMAL && size != FS_MONO) : 0;
 	}
 
+	if (key <= 0xFFFF && _glyph_widths[size] != NULL && _glyph_widths[size][key] != GLYPH_WIDTH_UNKNOWN) return _glyph_widths[size][key];
+
 	glyph = GetGlyphPtr(size, key);
-	if (glyph == NULL || glyph->sprite == NULL) {
-		GetGlyph(size, key);
-		glyph = GetGlyphPtr(size, key);
+	if (glyph != NULL && glyph->sprite != NULL) return glyph->width;
+
+	/* Only load the metrics of the glyph; it is rendered when it is drawn. */
+	FT_UInt glyph_index = FT_Get_Char_Index(face, key);
+	if (glyph_index != 0 && FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT) == FT_Err_Ok) {
+		byte width = face->glyph->advance.x >> 6;
+		SetGlyphWidth(size, key, width);
+		return width;
 	}
 
+	/* Missing characters are drawn as '?', so let GetGlyph sort that out. */
+	GetGlyph(size, key);
+	glyph = GetGlyphPtr(size, key);
+
 	return glyph->width;
 }
 
+/**
+ * Check whether the font has a glyph for a character, without rendering it.
+ * @param size The font size.
+ * @param key The character.
+ * @return False when the character is drawn as '?' instead.
+ */
+bool HasGlyph(FontSize size, WChar key)
+{
+	FT_Face face = GetFontFace(size);
+	if (face == NULL || (key >= SCC_SPRITE_START && key <= SCC_SPRITE_END)) return GetUnicodeGlyph(size, key) != 0;
+
+	return FT_Get_Char_Index(face, key) != 0;
+}
+
+/**
+ * Queue the glyph of a character to be rendered by #ProcessGlyphPrefetchQueue,
+ * before it is drawn. The glyph is rendered again whenever the glyph cache has
+ * been cleared, until #ClearGlyphPrefetchQueue is called.
+ * @param size The font size.
+ * @param key The character.
+ */
+void PrefetchGlyph(FontSize size, WChar key)
+{
+	if (key > 0xFFFF || (key >= SCC_SPRITE_START && key <= SCC_SPRITE_END)) return;
+	if (HasBit(_glyph_prefetch_queued[size][key / 8], key % 8)) return;
+
+	SetBit(_glyph_prefetch_queued[size][key / 8], key % 8);
+	*_glyph_prefetch.Append() = size << 16 | key;
+}
+
+/** Forget all glyphs that were queued with #PrefetchGlyph. */
+void ClearGlyphPrefetchQueue()
+{
+	_glyph_prefetch.Clear();
+	_glyph_prefetch_pos = 0;
+	memset(_glyph_prefetch_queued, 0, sizeof(_glyph_prefetch_queued));
+}
+
+/** Render some of the queued glyphs that are not in the glyph cache yet. */
+void ProcessGlyphPrefetchQueue()
+{
+	for (uint i = 0; i < MAX_GLYPH_PREFETCH_PER_LOOP && _glyph_prefetch_pos < _glyph_prefetch.Length(); _glyph_prefetch_pos++) {
+		FontSize size = (FontSize)GB(_glyph_prefetch[_glyph_prefetch_pos], 16, 8);
+		WChar key = GB(_glyph_prefetch[_glyph_prefetch_pos], 0, 16);
+		if (GetFontFace(size) == NULL) continue;
+
+		const GlyphEntry *glyph = GetGlyphPtr(size, key);
+		if (glyph != NULL && glyph->sprite != NULL) continue;
+
+		GetGlyph(size, key);
+		i++;
+	}
+}
+
 
 #endif /* WITH_FREETYPE */
 
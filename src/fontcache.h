@@ -48,6 +48,10 @@ void ClearFontCache();
 const Sprite *GetGlyph(FontSize size, uint32 key);
 uint GetGlyphWidth(FontSize size, uint32 key);
 bool GetDrawGlyphShadow();
+bool HasGlyph(FontSize size, uint32 key);
+void PrefetchGlyph(FontSize size, uint32 key);
+void ClearGlyphPrefetchQueue();
+void ProcessGlyphPrefetchQueue();
 
 /**
  * We would like to have a fallback font as the current one
@@ -90,6 +94,17 @@ static inline bool GetDrawGlyphShadow()
 	return false;
 }
 
+/** Check whether there is a glyph for a character, or whether it is drawn as '?' */
+static inline bool HasGlyph(FontSize size, uint32 key)
+{
+	return GetUnicodeGlyph(size, key) != 0;
+}
+
+/* Sprite glyphs are not rendered, so there is nothing to prefetch. */
+static inline void PrefetchGlyph(FontSize size, uint32 key) {}
+static inline void ClearGlyphPrefetchQueue() {}
+static inline void ProcessGlyphPrefetchQueue() {}
+
 #endif /* WITH_FREETYPE */
 
 #endif /* FONTCACHE_H */
@@ -29,6 +29,7 @@
 #include "newgrf.h"
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
+#include "thread/thread.h"
 #include "progress.h"
 #include "error.h"
 #include "game/game.hpp"
@@ -66,6 +67,55 @@ bool IsGenerateWorldThreaded()
 	return _gw.threaded && !_gw.quit_thread;
 }
 
+/** Maximum number of threads a pass of the world generation is spread over. */
+static const uint MAX_GENWORLD_THREADS = 16;
+/** Minimum number of rows per thread, so small maps do not pay for starting threads. */
+static const uint MIN_GENWORLD_ROWS_PER_THREAD = 64;
+
+/** A pass over rows that is spread over threads. */
+struct GenWorldRowsJob {
+	GenWorldRowsProc *proc; ///< The pass.
+	void *data;             ///< Data of the pass.
+	uint rows;              ///< The number of rows.
+};
+
+/**
+ * Do the pass over one band of the rows.
+ * @param part The band to do.
+ * @param parts The number of bands.
+ * @param data The #GenWorldRowsJob.
+ */
+static void DoGenWorldRowsPart(uint part, uint parts, void *data)
+{
+	const GenWorldRowsJob *job = (const GenWorldRowsJob *)data;
+	job->proc(job->rows * part / parts, job->rows * (part + 1) / parts, job->data);
+}
+
+/**
+ * Do a pass of the world generation over rows, split into bands that are
+ * spread over as many threads as there are cores. The rows of a pass must not
+ * depend on each other and must not draw random numbers, so the result is the
+ * same as when doing all rows in order. When no threads can be started the
+ * bands are done on the current thread.
+ * @note The threads are started for each pass and stopped when it is done,
+ *       instead of being kept in a pool of workers between passes. There are
+ *       only a handful of passes, each over the whole map, so starting the
+ *       threads costs little compared to the pass itself.
+ * @param rows The number of rows.
+ * @param proc The pass.
+ * @param data Data of the pass.
+ */
+void GenerateWorldRowsInParallel(uint rows, GenWorldRowsProc *proc, void *data)
+{
+	uint num_threads = Clamp(GetCPUCoreCount(), 1U, min(MAX_GENWORLD_THREADS, max(rows / MIN_GENWORLD_ROWS_PER_THREAD, 1U)));
+
+	GenWorldRowsJob job;
+	job.proc = proc;
+	job.data = data;
+	job.rows = rows;
+	RunParallel(num_threads, &DoGenWorldRowsPart, &job);
+}
+
 /**
  * Clean up the 'mess' of generation. That is, show windows again, reset
  * thread variables, and delete the progress window.
@@ -187,6 +237,7 @@ static void _GenerateWorld(void *)
 		/* Call any callback */
 		if (_gw.proc != NULL) _gw.proc();
 		IncreaseGeneratingWorldProgress(GWP_GAME_START);
+		LogGenerateWorldProgressTimes();
 
 		CleanupGeneration();
 		_modal_progress_work_mutex->EndCritical();
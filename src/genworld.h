@@ -70,8 +70,17 @@ enum GenWorldProgress {
 	GWP_CLASS_COUNT
 };
 
+/**
+ * A pass of the world generation over a band of rows.
+ * @param first The first row of the band.
+ * @param last The row after the band.
+ * @param data Data of the pass.
+ */
+typedef void GenWorldRowsProc(uint first, uint last, void *data);
+
 /* genworld.cpp */
 bool IsGenerateWorldThreaded();
+void GenerateWorldRowsInParallel(uint rows, GenWorldRowsProc *proc, void *data);
 void GenerateWorldSetCallback(GWDoneProc *proc);
 void GenerateWorldSetAbortCallback(GWAbortProc *proc);
 void WaitTillGeneratedWorld();
@@ -86,6 +95,7 @@ void SetGeneratingWorldProgress(GenWorldProgress cls, uint total);
 void IncreaseGeneratingWorldProgress(GenWorldProgress cls);
 void PrepareGenerateWorldProgress();
 void ShowGenerateWorldProgress();
+void LogGenerateWorldProgressTimes();
 void StartNewGameWithoutGUI(uint seed);
 void ShowCreateScenario();
 void StartScenarioEditor();
@@ -1138,10 +1138,39 @@ struct GenWorldStatus {
 	uint current;
 	uint total;
 	int timer;
+	GenWorldProgress stage;                        ///< The stage that is being timed, or #GWP_CLASS_COUNT.
+	RealTimeTimer stage_time[GWP_CLASS_COUNT];     ///< Time spent in each stage.
 };
 
 static GenWorldStatus _gws;
 
+/**
+ * Get the time spent in a stage of the world generation so far.
+ * @param stage The stage.
+ * @return The time in milliseconds.
+ */
+static uint GetGenerateWorldStageTime(GenWorldProgress stage)
+{
+	if (stage >= GWP_CLASS_COUNT) return 0;
+
+	RealTimeTimer timer = _gws.stage_time[stage];
+	if (stage == _gws.stage) timer.Stop();
+	return timer.GetMilliseconds();
+}
+
+/**
+ * Start timing a stage of the world generation, and stop timing the previous one.
+ * @param stage The stage, or #GWP_CLASS_COUNT to only stop timing.
+ */
+static void StartGenerateWorldStageTime(GenWorldProgress stage)
+{
+	if (stage == _gws.stage) return;
+
+	if (_gws.stage != GWP_CLASS_COUNT) _gws.stage_time[_gws.stage].Stop();
+	_gws.stage = stage;
+	if (_gws.stage != GWP_CLASS_COUNT) _gws.stage_time[_gws.stage].Start();
+}
+
 static const StringID _generation_class_table[]  = {
 	STR_GENERATION_WORLD_GENERATION,
 	STR_SCENEDIT_TOOLBAR_LANDSCAPE_GENERATION,
@@ -1206,7 +1235,9 @@ struct GenerateProgressWindow : public Window {
 				for (uint i = 0; i < GWP_CLASS_COUNT; i++) {
 					size->width = max(size->width, GetStringBoundingBox(_generation_class_table[i]).width);
 				}
-				size->height = FONT_HEIGHT_NORMAL * 2 + WD_PAR_VSEP_NORMAL;
+				SetDParamMaxDigits(0, 6);
+				size->width = max(size->width, GetStringBoundingBox(STR_GENERATION_PROGRESS_TIME).width);
+				size->height = FONT_HEIGHT_NORMAL * 3 + WD_PAR_VSEP_NORMAL * 2;
 				break;
 		}
 	}
@@ -1230,6 +1261,10 @@ struct GenerateProgressWindow : public Window {
 				SetDParam(0, _gws.current);
 				SetDParam(1, _gws.total);
 				DrawString(r.left, r.right, r.top + FONT_HEIGHT_NORMAL + WD_PAR_VSEP_NORMAL, STR_GENERATION_PROGRESS_NUM, TC_FROMSTRING, SA_HOR_CENTER);
+
+				/* And how long that class has been taking */
+				SetDParam(0, GetGenerateWorldStageTime(_gws.stage));
+				DrawString(r.left, r.right, r.top + (FONT_HEIGHT_NORMAL + WD_PAR_VSEP_NORMAL) * 2, STR_GENERATION_PROGRESS_TIME, TC_FROMSTRING, SA_HOR_CENTER);
 		}
 	}
 };
@@ -1244,6 +1279,8 @@ void PrepareGenerateWorldProgress()
 	_gws.total   = 0;
 	_gws.percent = 0;
 	_gws.timer   = 0; // Forces to paint the progress window immediately
+	_gws.stage   = GWP_CLASS_COUNT;
+	for (uint i = 0; i < GWP_CLASS_COUNT; i++) _gws.stage_time[i] = RealTimeTimer();
 }
 
 /**
@@ -1261,6 +1298,8 @@ static void _SetGeneratingWorldProgress(GenWorldProgress cls, uint progress, uin
 	assert_compile(lengthof(percent_table) == GWP_CLASS_COUNT + 1);
 	assert(cls < GWP_CLASS_COUNT);
 
+	if (total != 0) StartGenerateWorldStageTime(cls);
+
 	/* Do not run this function if we aren't in a thread */
 	if (!IsGenerateWorldThreaded() && !_network_dedicated) return;
 
@@ -1344,3 +1383,16 @@ void IncreaseGeneratingWorldProgress(GenWorldProgress cls)
 	/* In fact the param 'class' isn't needed.. but for some security reasons, we want it around */
 	_SetGeneratingWorldProgress(cls, 1, 0);
 }
+
+/** Stop timing the world generation, and log the time spent in each of its stages. */
+void LogGenerateWorldProgressTimes()
+{
+	StartGenerateWorldStageTime(GWP_CLASS_COUNT);
+
+	for (uint i = 0; i < GWP_CLASS_COUNT; i++) {
+		char name[64];
+		GetString(name, _generation_class_table[i], lastof(name));
+		str_strip_colours(name);
+		DEBUG(misc, 1, "Map generation: %6u ms %s", GetGenerateWorldStageTime((GenWorldProgress)i), name);
+	}
+}
@@ -22,6 +22,7 @@
 #include "network/network_func.h"
 #include "window_func.h"
 #include "newgrf_debug.h"
+#include "gfx_layout_cache.h"
 
 #include "table/palettes.h"
 #include "table/sprites.h"
@@ -110,6 +111,12 @@ static const uint DIRTY_BLOCK_WIDTH    = 64;
 
 static uint _dirty_bytes_per_line = 0;
 static byte *_dirty_blocks = NULL;
+static bool *_dirty_rows = NULL; ///< For each line of dirty blocks, whether any of its blocks may be dirty.
+
+/** Number of rectangles that are remembered to have been marked dirty since the last redraw. */
+static const uint RECENT_DIRTY_RECTS = 4;
+static Rect _recent_dirty_rects[RECENT_DIRTY_RECTS]; ///< Recently marked rectangles; (0, 0, 0, 0) when unused.
+static uint _recent_dirty_rect_next;                 ///< The entry of #_recent_dirty_rects to replace next.
 extern uint _dirty_block_colour;
 
 void GfxScroll(int left, int top, int width, int height, int xo, int yo)
@@ -344,6 +351,13 @@ static UChar *HandleBiDiAndArabicShapes(UChar *buffer)
 	}
 	input_output[length] = 0;
 
+	LayoutCacheKey key(LCK_BIDI, FS_NORMAL, _current_text_dir, buffer, length * sizeof(*buffer));
+	const LayoutCacheEntry *entry = FindLayout(key);
+	if (entry != NULL) {
+		memcpy(input_output, entry->GetData(), entry->data_length);
+		return input_output;
+	}
+
 	UErrorCode err = U_ZERO_ERROR;
 	UBiDi *para = ubidi_openSized((int32_t)length, 0, &err);
 	if (para == NULL) return buffer;
@@ -356,40 +370,41 @@ static UChar *HandleBiDiAndArabicShapes(UChar *buffer)
 	if (U_FAILURE(err)) return buffer;
 
 	input_output[length] = '\0';
+	CacheLayout(key, 0, 0, input_output, (length + 1) * sizeof(*input_output));
 	return input_output;
 }
 #endif /* WITH_ICU */
 
 
 /**
- * Truncate a given string to a maximum width if neccessary.
- * If the string is truncated, add three dots ('...') to show this.
- * @param *str string that is checked and possibly truncated
+ * Determine whether and where a string has to be truncated to fit a maximum width.
+ * @param str string that is checked
  * @param maxw maximum width in pixels of the string
  * @param ignore_setxy whether to ignore SETX(Y) or not
  * @param start_fontsize Fontsize to start the text with
- * @return new width of (truncated) string
+ * @param[out] ddd_offset offset in the string where the three dots have to be put, or UINT32_MAX if it fits
+ * @return width of the string when it is truncated
  */
-static int TruncateString(char *str, int maxw, bool ignore_setxy, FontSize start_fontsize)
+static int MeasureTruncation(const char *str, int maxw, bool ignore_setxy, FontSize start_fontsize, uint32 *ddd_offset)
 {
+	const char *begin = str;
 	int w = 0;
 	FontSize size = start_fontsize;
 	int ddd, ddd_w;
 
 	WChar c;
-	char *ddd_pos;
+	const char *ddd_pos;
 
 	ddd_w = ddd = GetCharacterWidth(size, '.') * 3;
+	*ddd_offset = UINT32_MAX;
 
-	for (ddd_pos = str; (c = Utf8Consume(const_cast<const char **>(&str))) != '\0'; ) {
+	for (ddd_pos = str; (c = Utf8Consume(&str)) != '\0'; ) {
 		if (IsPrintable(c) && !IsTextDirectionChar(c)) {
 			w += GetCharacterWidth(size, c);
 
 			if (w > maxw) {
-				/* string got too big... insert dotdotdot, but make sure we do not
-				 * print anything beyond the string termination character. */
-				for (int i = 0; *ddd_pos != '\0' && i < 3; i++, ddd_pos++) *ddd_pos = '.';
-				*ddd_pos = '\0';
+				/* string got too big... dotdotdot has to be inserted. */
+				*ddd_offset = (uint32)(ddd_pos - begin);
 				return ddd_w;
 			}
 		} else {
@@ -420,6 +435,40 @@ static int TruncateString(char *str, int maxw, bool ignore_setxy, FontSize start
 	return w;
 }
 
+/**
+ * Truncate a given string to a maximum width if neccessary.
+ * If the string is truncated, add three dots ('...') to show this.
+ * @param *str string that is checked and possibly truncated
+ * @param maxw maximum width in pixels of the string
+ * @param ignore_setxy whether to ignore SETX(Y) or not
+ * @param start_fontsize Fontsize to start the text with
+ * @return new width of (truncated) string
+ */
+static int TruncateString(char *str, int maxw, bool ignore_setxy, FontSize start_fontsize)
+{
+	int w;
+	uint32 ddd_offset;
+
+	LayoutCacheKey key(LCK_TRUNCATE, start_fontsize, (uint32)maxw << 1 | ignore_setxy, str, strlen(str));
+	const LayoutCacheEntry *entry = FindLayout(key);
+	if (entry != NULL) {
+		w = entry->value[0];
+		ddd_offset = entry->value[1];
+	} else {
+		w = MeasureTruncation(str, maxw, ignore_setxy, start_fontsize, &ddd_offset);
+		CacheLayout(key, w, ddd_offset);
+	}
+
+	if (ddd_offset != UINT32_MAX) {
+		/* Insert dotdotdot, but make sure we do not print anything
+		 * beyond the string termination character. */
+		char *ddd_pos = str + ddd_offset;
+		for (int i = 0; *ddd_pos != '\0' && i < 3; i++, ddd_pos++) *ddd_pos = '.';
+		*ddd_pos = '\0';
+	}
+	return w;
+}
+
 static int ReallyDoDrawString(const UChar *string, int x, int y, DrawStringParams &params, bool parse_string_also_when_clipped = false);
 
 /**
@@ -430,6 +479,13 @@ static int ReallyDoDrawString(const UChar *string, int x, int y, DrawStringParam
  */
 static int GetStringWidth(const UChar *str, FontSize start_fontsize)
 {
+	size_t length = 0;
+	while (str[length] != 0) length++;
+
+	LayoutCacheKey key(LCK_WIDTH, start_fontsize, 0, str, length * sizeof(*str));
+	const LayoutCacheEntry *entry = FindLayout(key);
+	if (entry != NULL) return entry->value[0];
+
 	FontSize size = start_fontsize;
 	int max_width;
 	int width;
@@ -457,6 +513,7 @@ static int GetStringWidth(const UChar *str, FontSize start_fontsize)
 		}
 	}
 
+	CacheLayout(key, max(max_width, width));
 	return max(max_width, width);
 }
 
@@ -656,31 +713,17 @@ int DrawString(int left, int right, int top, StringID str, TextColour colour, St
 }
 
 /**
- * 'Correct' a string to a maximum length. Longer strings will be cut into
- * additional lines at whitespace characters if possible. The string parameter
- * is modified with terminating characters mid-string which are the
- * placeholders for the newlines.
- * The string WILL be truncated if there was no whitespace for the current
- * line's maximum width.
- *
- * @note To know if the terminating '\0' is the string end or just a
- * newline, the returned 'num' value should be consulted. The num'th '\0',
- * starting with index 0 is the real string end.
- *
+ * Insert the line breaks of #FormatStringLinebreaks without looking in the layout cache.
  * @param str string to check and correct for length restrictions
  * @param last the last valid location (for '\0') in the buffer of str
  * @param maxw the maximum width the string can have on one line
  * @param size Fontsize to start the text with
- * @return return a 32bit wide number consisting of 2 packed values:
- *  0 - 15 the number of lines ADDED to the string
- * 16 - 31 the fontsize in which the length calculation was done at
+ * @return the number of lines added and the font size, like #FormatStringLinebreaks
  */
-uint32 FormatStringLinebreaks(char *str, const char *last, int maxw, FontSize size)
+static uint32 DoFormatStringLinebreaks(char *str, const char *last, int maxw, FontSize size)
 {
 	int num = 0;
 
-	assert(maxw > 0);
-
 	for (;;) {
 		/* The character *after* the last space. */
 		char *last_space = NULL;
@@ -763,6 +806,53 @@ end_of_inner_loop:
 	}
 }
 
+/**
+ * 'Correct' a string to a maximum length. Longer strings will be cut into
+ * additional lines at whitespace characters if possible. The string parameter
+ * is modified with terminating characters mid-string which are the
+ * placeholders for the newlines.
+ * The string WILL be truncated if there was no whitespace for the current
+ * line's maximum width.
+ *
+ * @note To know if the terminating '\0' is the string end or just a
+ * newline, the returned 'num' value should be consulted. The num'th '\0',
+ * starting with index 0 is the real string end.
+ *
+ * @param str string to check and correct for length restrictions
+ * @param last the last valid location (for '\0') in the buffer of str
+ * @param maxw the maximum width the string can have on one line
+ * @param size Fontsize to start the text with
+ * @return return a 32bit wide number consisting of 2 packed values:
+ *  0 - 15 the number of lines ADDED to the string
+ * 16 - 31 the fontsize in which the length calculation was done at
+ */
+uint32 FormatStringLinebreaks(char *str, const char *last, int maxw, FontSize size)
+{
+	assert(maxw > 0);
+
+	/* The string is modified in place, so a copy of the original is needed for the key. */
+	char original[DRAW_STRING_BUFFER];
+	size_t length = strlen(str);
+	if (length >= lengthof(original)) return DoFormatStringLinebreaks(str, last, maxw, size);
+	memcpy(original, str, length);
+
+	/* The result depends on the room in the buffer when the string fills it. */
+	LayoutCacheKey key(LCK_LINEBREAKS, size, (uint32)maxw | (uint32)min<size_t>(last - str, 0xFFFF) << 16, original, length);
+	const LayoutCacheEntry *entry = FindLayout(key);
+	if (entry != NULL) {
+		memcpy(str, entry->GetData(), entry->data_length);
+		return entry->value[0];
+	}
+
+	uint32 result = DoFormatStringLinebreaks(str, last, maxw, size);
+
+	/* Cache the lines up to and including the real string end. */
+	const char *end = str;
+	for (uint i = 0; i <= GB(result, 0, 16); i++) end += strlen(end) + 1;
+	CacheLayout(key, result, 0, str, end - str);
+	return result;
+}
+
 
 /**
  * Calculates height of string (in pixels). Accepts multiline string with '\0' as separators.
@@ -1010,6 +1100,13 @@ int DrawStringMultiLine(int left, int right, int top, int bottom, StringID str,
  */
 Dimension GetStringBoundingBox(const char *str, FontSize start_fontsize)
 {
+	LayoutCacheKey key(LCK_BOUNDING_BOX, start_fontsize, 0, str, strlen(str));
+	const LayoutCacheEntry *entry = FindLayout(key);
+	if (entry != NULL) {
+		Dimension br = {entry->value[0], entry->value[1]};
+		return br;
+	}
+
 	FontSize size = start_fontsize;
 	Dimension br;
 	uint max_width;
@@ -1041,6 +1138,7 @@ Dimension GetStringBoundingBox(const char *str, FontSize start_fontsize)
 	br.height += GetCharacterHeight(size);
 
 	br.width  = max(br.width, max_width);
+	CacheLayout(key, br.width, br.height);
 	return br;
 }
 
@@ -1580,6 +1678,9 @@ void LoadStringWidthTable(bool monospace)
 		_max_char_size[fs].height++;
 	}
 
+	/* All layouts were measured with the old glyphs. */
+	ClearLayoutCache();
+
 	_max_char_width  = 0;
 	_max_char_height = 0;
 	for (FontSize fs = FS_BEGIN; fs < FS_END; fs++) {
@@ -1623,11 +1724,18 @@ void ScreenSizeChanged()
 {
 	_dirty_bytes_per_line = CeilDiv(_screen.width, DIRTY_BLOCK_WIDTH);
 	_dirty_blocks = ReallocT<byte>(_dirty_blocks, _dirty_bytes_per_line * CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	_dirty_rows = ReallocT<bool>(_dirty_rows, CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
 
 	/* check the dirty rect */
 	if (_invalid_rect.right >= _screen.width) _invalid_rect.right = _screen.width;
 	if (_invalid_rect.bottom >= _screen.height) _invalid_rect.bottom = _screen.height;
 
+	/* The blocks no longer match the screen, so everything has to be redrawn. */
+	memset(_dirty_blocks, 0, _dirty_bytes_per_line * CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	memset(_dirty_rows, 0, CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	memset(_recent_dirty_rects, 0, sizeof(_recent_dirty_rects));
+	MarkWholeScreenDirty();
+
 	/* screen size changed and the old bitmap is invalid now, so we don't want to undraw it */
 	_cursor.visible = false;
 }
@@ -1735,11 +1843,8 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
  */
 void DrawDirtyBlocks()
 {
-	byte *b = _dirty_blocks;
 	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
 	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
-	int x;
-	int y;
 
 	if (HasModalProgress()) {
 		/* We are generating the world, so release our rights to the map and
@@ -1760,10 +1865,19 @@ void DrawDirtyBlocks()
 		if (_switch_mode != SM_NONE && !HasModalProgress()) return;
 	}
 
-	y = 0;
-	do {
-		x = 0;
-		do {
+	/* Only blocks within the invalid rectangle can be dirty, and of
+	 * those only the ones in lines that are marked as dirty. When
+	 * nothing has been marked, nothing is looked at. */
+	const int x_begin = _invalid_rect.left - _invalid_rect.left % DIRTY_BLOCK_WIDTH;
+	const int x_end = Align(_invalid_rect.right, DIRTY_BLOCK_WIDTH);
+	const int y_end = Align(_invalid_rect.bottom, DIRTY_BLOCK_HEIGHT);
+
+	for (int y = _invalid_rect.top - _invalid_rect.top % DIRTY_BLOCK_HEIGHT; y < y_end; y += DIRTY_BLOCK_HEIGHT) {
+		if (!_dirty_rows[y / DIRTY_BLOCK_HEIGHT]) continue;
+		_dirty_rows[y / DIRTY_BLOCK_HEIGHT] = false;
+
+		byte *b = _dirty_blocks + (y / DIRTY_BLOCK_HEIGHT) * _dirty_bytes_per_line + x_begin / DIRTY_BLOCK_WIDTH;
+		for (int x = x_begin; x < x_end; x += DIRTY_BLOCK_WIDTH, b++) {
 			if (*b != 0) {
 				int left;
 				int top;
@@ -1819,14 +1933,15 @@ void DrawDirtyBlocks()
 				}
 
 			}
-		} while (b++, (x += DIRTY_BLOCK_WIDTH) != w);
-	} while (b += -(int)(w / DIRTY_BLOCK_WIDTH) + _dirty_bytes_per_line, (y += DIRTY_BLOCK_HEIGHT) != h);
+		}
+	}
 
 	++_dirty_block_colour;
 	_invalid_rect.left = w;
 	_invalid_rect.top = h;
 	_invalid_rect.right = 0;
 	_invalid_rect.bottom = 0;
+	memset(_recent_dirty_rects, 0, sizeof(_recent_dirty_rects));
 }
 
 /**
@@ -1857,6 +1972,19 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 
 	if (left >= right || top >= bottom) return;
 
+	/* Windows are often marked dirty many times before they are redrawn;
+	 * skip rectangles that lie within one that has already been marked. */
+	for (uint i = 0; i < RECENT_DIRTY_RECTS; i++) {
+		const Rect &r = _recent_dirty_rects[i];
+		if (r.left <= left && r.top <= top && right <= r.right && bottom <= r.bottom) return;
+	}
+	Rect &recent = _recent_dirty_rects[_recent_dirty_rect_next];
+	recent.left = left;
+	recent.top = top;
+	recent.right = right;
+	recent.bottom = bottom;
+	_recent_dirty_rect_next = (_recent_dirty_rect_next + 1) % RECENT_DIRTY_RECTS;
+
 	if (left   < _invalid_rect.left  ) _invalid_rect.left   = left;
 	if (top    < _invalid_rect.top   ) _invalid_rect.top    = top;
 	if (right  > _invalid_rect.right ) _invalid_rect.right  = right;
@@ -1872,6 +2000,8 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 
 	assert(width > 0 && height > 0);
 
+	for (int i = 0; i < height; i++) _dirty_rows[top + i] = true;
+
 	do {
 		int i = width;
 
@@ -0,0 +1,165 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file gfx_layout_cache.cpp Cache of the measured layout of strings. */
+
+#include "stdafx.h"
+#include "gfx_layout_cache.h"
+#include "core/alloc_func.hpp"
+
+static const uint LAYOUT_CACHE_SETS       = 1024; ///< Number of sets in the cache; must be a power of 2.
+static const uint LAYOUT_CACHE_WAYS       =    4; ///< Number of entries in each set.
+static const uint LAYOUT_CACHE_MAX_LENGTH = 1024; ///< Longest string, in bytes, of which the layout is cached.
+
+/**
+ * The cached layouts. A layout can only be in the set selected by its hash,
+ * so a lookup compares at most #LAYOUT_CACHE_WAYS entries.
+ */
+static LayoutCacheEntry _layout_cache[LAYOUT_CACHE_SETS * LAYOUT_CACHE_WAYS];
+static uint32 _layout_cache_clock;           ///< Counter that is increased for every use of an entry.
+static LayoutCacheStats _layout_cache_stats; ///< Statistics of the layout cache.
+
+/**
+ * Create the key of a layout, and determine its hash.
+ * @param kind Kind of information that is looked for.
+ * @param size Font size the string starts with.
+ * @param param Other input the information depends on.
+ * @param data The string.
+ * @param length Length of the string in bytes.
+ */
+LayoutCacheKey::LayoutCacheKey(LayoutCacheKind kind, FontSize size, uint32 param, const void *data, size_t length) :
+		kind(kind), size(size), param(param), data(data), length(length)
+{
+	/* FNV-1a over the string, with the other parts of the key mixed in first. */
+	uint32 hash = 2166136261U;
+	hash = (hash ^ (kind | size << 8)) * 16777619U;
+	hash = (hash ^ param) * 16777619U;
+	const byte *p = (const byte *)data;
+	for (size_t i = 0; i < length; i++) hash = (hash ^ p[i]) * 16777619U;
+
+	/* A hash of 0 marks unused entries. */
+	this->hash = hash != 0 ? hash : 1;
+}
+
+/**
+ * Get the first entry of the set a layout belongs to.
+ * @param key The key of the layout.
+ * @return The entries of the set.
+ */
+static inline LayoutCacheEntry *GetLayoutCacheSet(const LayoutCacheKey &key)
+{
+	return &_layout_cache[(key.hash & (LAYOUT_CACHE_SETS - 1)) * LAYOUT_CACHE_WAYS];
+}
+
+/**
+ * Free the string and data of an entry, and mark it unused.
+ * @param entry The entry to free.
+ */
+static void FreeLayoutCacheEntry(LayoutCacheEntry *entry)
+{
+	_layout_cache_stats.entries--;
+	_layout_cache_stats.used -= entry->key_length + entry->data_length;
+	free(entry->buffer);
+	entry->buffer = NULL;
+	entry->hash = 0;
+}
+
+/**
+ * Look for the layout of a string in the cache.
+ * @param key The key of the layout.
+ * @return The cached layout, or \c NULL when it is not cached.
+ */
+const LayoutCacheEntry *FindLayout(const LayoutCacheKey &key)
+{
+	if (key.length > LAYOUT_CACHE_MAX_LENGTH) return NULL;
+
+	LayoutCacheEntry *set = GetLayoutCacheSet(key);
+	for (uint i = 0; i < LAYOUT_CACHE_WAYS; i++) {
+		LayoutCacheEntry *entry = &set[i];
+		if (entry->hash == key.hash && entry->kind == key.kind && entry->size == key.size && entry->param == key.param &&
+				entry->key_length == key.length && memcmp(entry->buffer, key.data, key.length) == 0) {
+			entry->last_used = ++_layout_cache_clock;
+			_layout_cache_stats.hits++;
+			return entry;
+		}
+	}
+
+	_layout_cache_stats.misses++;
+	return NULL;
+}
+
+/**
+ * Add the layout of a string to the cache, replacing the least recently
+ * used layout in its set if the set is full.
+ * @param key The key of the layout.
+ * @param value0 First value of the information.
+ * @param value1 Second value of the information.
+ * @param data Extra data of the information.
+ * @param data_length Length of the extra data in bytes.
+ */
+void CacheLayout(const LayoutCacheKey &key, uint32 value0, uint32 value1, const void *data, size_t data_length)
+{
+	if (key.length > LAYOUT_CACHE_MAX_LENGTH) return;
+
+	LayoutCacheEntry *set = GetLayoutCacheSet(key);
+	LayoutCacheEntry *entry = &set[0];
+	for (uint i = 0; i < LAYOUT_CACHE_WAYS; i++) {
+		if (set[i].hash == 0) {
+			entry = &set[i];
+			break;
+		}
+		if ((int32)(set[i].last_used - entry->last_used) < 0) entry = &set[i];
+	}
+
+	if (entry->hash != 0) {
+		FreeLayoutCacheEntry(entry);
+		_layout_cache_stats.evictions++;
+	}
+
+	entry->hash = key.hash;
+	entry->kind = key.kind;
+	entry->size = key.size;
+	entry->param = key.param;
+	entry->last_used = ++_layout_cache_clock;
+	entry->key_length = (uint32)key.length;
+	entry->data_length = (uint32)data_length;
+	entry->buffer = MallocT<byte>(key.length + data_length);
+	memcpy(entry->buffer, key.data, key.length);
+	if (data_length != 0) memcpy(entry->buffer + key.length, data, data_length);
+	entry->value[0] = value0;
+	entry->value[1] = value1;
+
+	_layout_cache_stats.entries++;
+	_layout_cache_stats.used += key.length + data_length;
+}
+
+/** Remove all layouts from the cache, e.g. because the fonts changed. */
+void ClearLayoutCache()
+{
+	for (uint i = 0; i < lengthof(_layout_cache); i++) {
+		if (_layout_cache[i].hash != 0) FreeLayoutCacheEntry(&_layout_cache[i]);
+	}
+}
+
+/**
+ * Get the statistics of the layout cache.
+ * @return The statistics.
+ */
+const LayoutCacheStats &GetLayoutCacheStats()
+{
+	return _layout_cache_stats;
+}
+
+/** Reset the hit, miss and eviction counters of the layout cache. */
+void ResetLayoutCacheStats()
+{
+	_layout_cache_stats.hits = 0;
+	_layout_cache_stats.misses = 0;
+	_layout_cache_stats.evictions = 0;
+}
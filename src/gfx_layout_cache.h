@@ -0,0 +1,76 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file gfx_layout_cache.h Cache of the measured layout of strings. */
+
+#ifndef GFX_LAYOUT_CACHE_H
+#define GFX_LAYOUT_CACHE_H
+
+#include "gfx_type.h"
+
+/** Kinds of information about the layout of a string that are cached. */
+enum LayoutCacheKind {
+	LCK_BOUNDING_BOX, ///< The bounding box of a string.
+	LCK_TRUNCATE,     ///< The width of a string, and where it has to be truncated to fit.
+	LCK_WIDTH,        ///< The width of a part of a string that is drawn.
+	LCK_LINEBREAKS,   ///< A string with line breaks inserted to make it fit.
+	LCK_BIDI,         ///< A string reordered and shaped for drawing.
+};
+
+/** What identifies the layout of a string in the cache. */
+struct LayoutCacheKey {
+	LayoutCacheKind kind; ///< Kind of information that is looked for.
+	FontSize size;        ///< Font size the string starts with.
+	uint32 param;         ///< Other input, like the maximum width, that the information depends on.
+	const void *data;     ///< The string.
+	size_t length;        ///< Length of the string in bytes.
+	uint32 hash;          ///< Hash of all the above.
+
+	LayoutCacheKey(LayoutCacheKind kind, FontSize size, uint32 param, const void *data, size_t length);
+};
+
+/** Cached information about the layout of a string. */
+struct LayoutCacheEntry {
+	uint32 hash;        ///< Hash of the key; 0 for unused entries.
+	byte kind;          ///< #LayoutCacheKind of the information.
+	byte size;          ///< #FontSize the string starts with.
+	uint32 param;       ///< Other input the information depends on.
+	uint32 last_used;   ///< When the entry was last used, for finding the least recently used entry.
+	uint32 key_length;  ///< Length of the string in bytes.
+	uint32 data_length; ///< Length of the extra data in bytes.
+	byte *buffer;       ///< The string, followed by the extra data.
+	uint32 value[2];    ///< The cached information, depending on the kind.
+
+	/**
+	 * Get the extra data of the information, like the string with line breaks.
+	 * @return The data.
+	 */
+	inline const byte *GetData() const
+	{
+		return this->buffer + this->key_length;
+	}
+};
+
+/** Statistics of the layout cache. */
+struct LayoutCacheStats {
+	uint64 hits;      ///< Number of lookups that found the layout in the cache.
+	uint64 misses;    ///< Number of lookups after which the layout had to be determined.
+	uint64 evictions; ///< Number of layouts removed to make room for others.
+	uint entries;     ///< Number of layouts in the cache.
+	size_t used;      ///< Bytes taken by the strings and data of the layouts.
+};
+
+const LayoutCacheEntry *FindLayout(const LayoutCacheKey &key);
+void CacheLayout(const LayoutCacheKey &key, uint32 value0, uint32 value1 = 0, const void *data = NULL, size_t data_length = 0);
+void ClearLayoutCache();
+
+const LayoutCacheStats &GetLayoutCacheStats();
+void ResetLayoutCacheStats();
+
+#endif /* GFX_LAYOUT_CACHE_H */
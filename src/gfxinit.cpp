@@ -15,8 +15,10 @@
 #include "3rdparty/md5/md5.h"
 #include "fontcache.h"
 #include "gfx_func.h"
+#include "gfx_layout_cache.h"
 #include "blitter/factory.hpp"
 #include "video/video_driver.hpp"
+#include "sprite_disk_cache.h"
 
 /* The type of set we're replacing */
 #define SET_TYPE "graphics"
@@ -38,17 +40,19 @@ static const SpriteID * const _landscape_spriteindexes[] = {
 
 /**
  * Load an old fashioned GRF file.
- * @param filename   The name of the file to open.
+ * @param file       The file to open.
  * @param load_index The offset of the first sprite.
  * @param file_index The Fio offset to load the file in.
  * @return The number of loaded sprites.
  */
-static uint LoadGrfFile(const char *filename, uint load_index, int file_index)
+static uint LoadGrfFile(const MD5File &file, uint load_index, int file_index)
 {
 	uint load_index_org = load_index;
 	uint sprite_id = 0;
+	const char *filename = file.filename;
 
 	FioOpenFile(file_index, filename, BASESET_DIR);
+	SetSpriteDiskCacheIdentity(file_index, file.hash);
 
 	DEBUG(sprite, 2, "Reading grf-file '%s'", filename);
 
@@ -75,17 +79,19 @@ static uint LoadGrfFile(const char *filename, uint load_index, int file_index)
 
 /**
  * Load an old fashioned GRF file to replace already loaded sprites.
- * @param filename   The name of the file to open.
+ * @param file       The file to open.
  * @param index_tlb  The offsets of each of the sprites.
  * @param file_index The Fio offset to load the file in.
  * @return The number of loaded sprites.
  */
-static void LoadGrfFileIndexed(const char *filename, const SpriteID *index_tbl, int file_index)
+static void LoadGrfFileIndexed(const MD5File &file, const SpriteID *index_tbl, int file_index)
 {
 	uint start;
 	uint sprite_id = 0;
+	const char *filename = file.filename;
 
 	FioOpenFile(file_index, filename, BASESET_DIR);
+	SetSpriteDiskCacheIdentity(file_index, file.hash);
 
 	DEBUG(sprite, 2, "Reading indexed grf-file '%s'", filename);
 
@@ -164,7 +170,7 @@ static void LoadSpriteTables()
 	const GraphicsSet *used_set = BaseGraphics::GetUsedSet();
 
 	_palette_remap_grf[i] = (PAL_DOS != used_set->palette);
-	LoadGrfFile(used_set->files[GFT_BASE].filename, 0, i++);
+	LoadGrfFile(used_set->files[GFT_BASE], 0, i++);
 
 	/*
 	 * The second basic file always starts at the given location and does
@@ -173,7 +179,7 @@ static void LoadSpriteTables()
 	 * sprites as they are not shown anyway (logos in intro game).
 	 */
 	_palette_remap_grf[i] = (PAL_DOS != used_set->palette);
-	LoadGrfFile(used_set->files[GFT_LOGOS].filename, 4793, i++);
+	LoadGrfFile(used_set->files[GFT_LOGOS], 4793, i++);
 
 	/*
 	 * Load additional sprites for climates other than temperate.
@@ -183,7 +189,7 @@ static void LoadSpriteTables()
 	if (_settings_game.game_creation.landscape != LT_TEMPERATE) {
 		_palette_remap_grf[i] = (PAL_DOS != used_set->palette);
 		LoadGrfFileIndexed(
-			used_set->files[GFT_ARCTIC + _settings_game.game_creation.landscape - 1].filename,
+			used_set->files[GFT_ARCTIC + _settings_game.game_creation.landscape - 1],
 			_landscape_spriteindexes[_settings_game.game_creation.landscape - 1],
 			i++
 		);
@@ -257,6 +263,7 @@ void GfxLoadSprites()
 
 	SwitchNewGRFBlitter();
 	ClearFontCache();
+	ClearLayoutCache();
 	GfxInitSpriteMem();
 	LoadSpriteTables();
 	GfxInitPalettes();
@@ -90,6 +90,9 @@ static const NWidgetPart _nested_group_widgets[] = {
 	EndContainer(),
 };
 
+/** Names of the groups of the list that is being sorted. */
+static GUIListStrings _group_sort_names;
+
 class VehicleGroupWindow : public BaseVehicleListWindow {
 private:
 	/* Columns in the group list */
@@ -134,25 +137,22 @@ private:
 		this->groups.RebuildDone();
 	}
 
-	/** Sort the groups by their name */
-	static int CDECL GroupNameSorter(const Group * const *a, const Group * const *b)
+	/** Determine the names of the groups, before sorting them by their name */
+	static void CDECL GroupNameSortKeys(const Group * const *groups, uint count)
 	{
-		static const Group *last_group[2] = { NULL, NULL };
-		static char         last_name[2][64] = { "", "" };
-
-		if (*a != last_group[0]) {
-			last_group[0] = *a;
-			SetDParam(0, (*a)->index);
-			GetString(last_name[0], STR_GROUP_NAME, lastof(last_name[0]));
-		}
-
-		if (*b != last_group[1]) {
-			last_group[1] = *b;
-			SetDParam(0, (*b)->index);
-			GetString(last_name[1], STR_GROUP_NAME, lastof(last_name[1]));
+		_group_sort_names.Clear();
+		for (uint i = 0; i < count; i++) {
+			char name[64];
+			SetDParam(0, groups[i]->index);
+			GetString(name, STR_GROUP_NAME, lastof(name));
+			_group_sort_names.Set(groups[i]->index, name);
 		}
+	}
 
-		int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+	/** Sort the groups by their name */
+	static int CDECL GroupNameSorter(const Group * const *a, const Group * const *b)
+	{
+		int r = strnatcmp(_group_sort_names.Get((*a)->index), _group_sort_names.Get((*b)->index)); // Sort by name (natural sorting).
 		if (r == 0) return (*a)->index - (*b)->index;
 		return r;
 	}
@@ -307,7 +307,7 @@ public:
 		this->groups.ForceRebuild();
 		this->groups.NeedResort();
 		this->BuildGroupList(vli.company);
-		this->groups.Sort(&GroupNameSorter);
+		this->groups.Sort(&GroupNameSorter, &GroupNameSortKeys);
 
 		this->GetWidget<NWidgetCore>(WID_GL_CAPTION)->widget_data = STR_VEHICLE_LIST_TRAIN_CAPTION + this->vli.vtype;
 		this->GetWidget<NWidgetCore>(WID_GL_LIST_VEHICLE)->tool_tip = STR_VEHICLE_LIST_TRAIN_LIST_TOOLTIP + this->vli.vtype;
@@ -441,7 +441,7 @@ public:
 		this->SortVehicleList();
 
 		this->BuildGroupList(this->owner);
-		this->groups.Sort(&GroupNameSorter);
+		this->groups.Sort(&GroupNameSorter, &GroupNameSortKeys);
 
 		this->group_sb->SetCount(this->groups.Length());
 		this->vscroll->SetCount(this->vehicles.Length());
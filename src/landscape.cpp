@@ -886,48 +886,71 @@ static void GenerateTerrain(int type, uint flag)
 
 #include "table/genland.h"
 
-static void CreateDesertOrRainForest()
+/**
+ * Make the tiles of a band of rows desert when there is no high land or water nearby.
+ * @param first The first row of the band.
+ * @param last The row after the band.
+ * @param data Unused.
+ */
+static void CreateDesertRows(uint first, uint last, void *data)
 {
-	TileIndex update_freq = MapSize() / 4;
-	const TileIndexDiffC *data;
-
-	for (TileIndex tile = 0; tile != MapSize(); ++tile) {
-		if ((tile % update_freq) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+	const TileIndexDiffC *data_end = endof(_make_desert_or_rainforest_data);
 
+	for (TileIndex tile = TileXY(0, first); tile != TileXY(0, last); ++tile) {
 		if (!IsValidTile(tile)) continue;
 
-		for (data = _make_desert_or_rainforest_data;
-				data != endof(_make_desert_or_rainforest_data); ++data) {
-			TileIndex t = AddTileIndexDiffCWrap(tile, *data);
+		const TileIndexDiffC *d;
+		for (d = _make_desert_or_rainforest_data; d != data_end; ++d) {
+			TileIndex t = AddTileIndexDiffCWrap(tile, *d);
 			if (t != INVALID_TILE && (TileHeight(t) >= 4 || IsTileType(t, MP_WATER))) break;
 		}
-		if (data == endof(_make_desert_or_rainforest_data)) {
+		if (d == data_end) {
 			SetTropicZone(tile, TROPICZONE_DESERT);
 		}
 	}
+}
 
-	for (uint i = 0; i != 256; i++) {
-		if ((i % 64) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
-
-		RunTileLoop();
-	}
-
-	for (TileIndex tile = 0; tile != MapSize(); ++tile) {
-		if ((tile % update_freq) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+/**
+ * Make the tiles of a band of rows rain forest when there is no desert nearby.
+ * @param first The first row of the band.
+ * @param last The row after the band.
+ * @param data Unused.
+ */
+static void CreateRainForestRows(uint first, uint last, void *data)
+{
+	const TileIndexDiffC *data_end = endof(_make_desert_or_rainforest_data);
 
+	for (TileIndex tile = TileXY(0, first); tile != TileXY(0, last); ++tile) {
 		if (!IsValidTile(tile)) continue;
 
-		for (data = _make_desert_or_rainforest_data;
-				data != endof(_make_desert_or_rainforest_data); ++data) {
-			TileIndex t = AddTileIndexDiffCWrap(tile, *data);
+		const TileIndexDiffC *d;
+		for (d = _make_desert_or_rainforest_data; d != data_end; ++d) {
+			TileIndex t = AddTileIndexDiffCWrap(tile, *d);
 			if (t != INVALID_TILE && IsTileType(t, MP_CLEAR) && IsClearGround(t, CLEAR_DESERT)) break;
 		}
-		if (data == endof(_make_desert_or_rainforest_data)) {
+		if (d == data_end) {
 			SetTropicZone(tile, TROPICZONE_RAINFOREST);
 		}
 	}
 }
 
+static void CreateDesertOrRainForest()
+{
+	/* Only the tropic zone of a tile is changed, and only the height, type and
+	 * ground of the nearby tiles are looked at, so the rows can be done in parallel. */
+	GenerateWorldRowsInParallel(MapSizeY(), &CreateDesertRows, NULL);
+	for (uint i = 0; i != 4; i++) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+
+	for (uint i = 0; i != 256; i++) {
+		if ((i % 64) == 0) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+
+		RunTileLoop();
+	}
+
+	GenerateWorldRowsInParallel(MapSizeY(), &CreateRainForestRows, NULL);
+	for (uint i = 0; i != 4; i++) IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
+}
+
 /**
  * Find the spring of a river.
  * @param tile The tile to consider for being the spring.
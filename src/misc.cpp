@@ -27,6 +27,7 @@
 #include "window_func.h"
 #include "core/pool_type.hpp"
 #include "game/game.hpp"
+#include "spatial_index.h"
 
 
 extern TileIndex _cur_tileloop_tile;
@@ -69,6 +70,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	}
 
 	PoolBase::Clean(PT_NORMAL);
+	ResetSpatialIndices();
 
 	ResetPersistentNewGRFData();
 
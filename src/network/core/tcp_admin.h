@@ -33,6 +33,7 @@ enum PacketAdminType {
 	ADMIN_PACKET_ADMIN_CHAT,             ///< The admin sends a chat message to be distributed.
 	ADMIN_PACKET_ADMIN_RCON,             ///< The admin sends a remote console command.
 	ADMIN_PACKET_ADMIN_GAMESCRIPT,       ///< The admin sends a JSON string for the GameScript.
+	ADMIN_PACKET_ADMIN_QUERY,            ///< The admin asks for the saved state of a range of game objects.
 
 	ADMIN_PACKET_SERVER_FULL = 100,      ///< The server tells the admin it cannot accept the admin.
 	ADMIN_PACKET_SERVER_BANNED,          ///< The server tells the admin it is banned.
@@ -60,6 +61,8 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_CMD_NAMES,       ///< The server sends out the names of the DoCommands to the admins.
 	ADMIN_PACKET_SERVER_CMD_LOGGING,     ///< The server gives the admin copies of incoming command packets.
 	ADMIN_PACKET_SERVER_GAMESCRIPT,      ///< The server gives the admin information from the GameScript in JSON.
+	ADMIN_PACKET_SERVER_PERFORMANCE,     ///< The server gives the admin the changes of its performance counters.
+	ADMIN_PACKET_SERVER_QUERY,           ///< The server gives the admin the saved state of a range of game objects.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -83,6 +86,7 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_PERFORMANCE,     ///< The admin would like to have the performance counters.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -98,6 +102,33 @@ enum AdminUpdateFrequency {
 };
 DECLARE_ENUM_AS_BIT_SET(AdminUpdateFrequency)
 
+/** Metrics in the performance packet; the bits of its mask. */
+enum AdminPerformanceMetric {
+	ADMIN_PERF_TICKS,                ///< Number of game ticks that were run.
+	ADMIN_PERF_TICK_TIME,            ///< Time spent running game ticks, in microseconds.
+	ADMIN_PERF_PATHFINDER_CALLS,     ///< Number of times a vehicle asked a pathfinder for a track.
+	ADMIN_PERF_CARGO_DELIVERED,      ///< Amount of cargo that was delivered to its destination.
+	ADMIN_PERF_CARGO_WAITING,        ///< Amount of cargo waiting at all stations.
+	ADMIN_PERF_VEHICLES_RUNNING,     ///< Number of vehicles that are on their way.
+	ADMIN_PERF_VEHICLES_LOADING,     ///< Number of vehicles that are loading or unloading at a station.
+	ADMIN_PERF_VEHICLES_BROKEN_DOWN, ///< Number of vehicles that are broken down.
+	ADMIN_PERF_VEHICLES_STOPPED,     ///< Number of vehicles that are stopped outside a depot.
+	ADMIN_PERF_VEHICLES_IN_DEPOT,    ///< Number of vehicles that are in a depot.
+
+	ADMIN_PERF_END,                  ///< Sentinel for end.
+};
+
+/** Kinds of game objects an admin can query the state of. */
+enum AdminQueryType {
+	ADMIN_QUERY_VEHICLES,   ///< The vehicles.
+	ADMIN_QUERY_STATIONS,   ///< The stations and waypoints.
+	ADMIN_QUERY_TOWNS,      ///< The towns.
+	ADMIN_QUERY_INDUSTRIES, ///< The industries.
+	ADMIN_QUERY_COMPANIES,  ///< The companies.
+
+	ADMIN_QUERY_END,        ///< Sentinel for end.
+};
+
 /** Reasons for removing a company - communicated to admins. */
 enum AdminCompanyRemoveReason {
 	ADMIN_CRR_MANUAL,    ///< The company is manually removed.
@@ -180,6 +211,18 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_ADMIN_GAMESCRIPT(Packet *p);
 
+	/**
+	 * Query the state of a range of game objects of one kind; the server
+	 * answers with one or more SERVER_QUERY packets. Invalid queries get
+	 * silently dropped.
+	 * uint8   #AdminQueryType of the objects.
+	 * uint32  Index of the first object to look at.
+	 * uint16  Maximum number of objects to return.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_ADMIN_QUERY(Packet *p);
+
 	/**
 	 * The server is full (connection gets closed).
 	 * @param p The packet that was just received.
@@ -454,6 +497,43 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_CMD_LOGGING(Packet *p);
 
+	/**
+	 * Send the changes of the performance counters since the previous packet
+	 * of this type to the admin network. The first packet after registering
+	 * for the updates holds the changes since zero, i.e. the current values.
+	 * uint32  Frame of the game.
+	 * uint16  Mask of the metrics that changed (see #AdminPerformanceMetric).
+	 * For every metric that changed, in the order of #AdminPerformanceMetric:
+	 * varint  Change of the metric. The bytes hold 7 bits of the zigzag encoded
+	 *         change each, least significant first; the high bit tells another
+	 *         byte follows. A zigzag encoded change of z decodes to (z >> 1) ^ -(z & 1).
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_PERFORMANCE(Packet *p);
+
+	/**
+	 * Send the state of a range of game objects, as it is stored in a
+	 * savegame, in answer to a QUERY packet. All packets of one answer
+	 * describe the game at the same moment; large answers are split over
+	 * several packets, of which only the last has the last-packet flag set.
+	 * uint8   #AdminQueryType of the objects.
+	 * uint32  Frame of the game the state belongs to.
+	 * uint16  Savegame version the objects are stored in.
+	 * uint32  Index to query next to continue the listing, or UINT32_MAX
+	 *         when there are no more objects. When the server is saving the
+	 *         game it cannot answer; it then sends an empty answer with the
+	 *         index of the query, and the query has to be sent again later.
+	 * bool    Whether this is the last packet of the answer.
+	 * The rest of the packets of an answer form a single stream of objects:
+	 * uint32  Index of the object.
+	 * uint32  Length of the object's data.
+	 * bytes   The data, as in the object's savegame chunk.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_QUERY(Packet *p);
+
 	NetworkRecvStatus HandlePacket(Packet *p);
 public:
 	NetworkRecvStatus CloseConnection(bool error = true);
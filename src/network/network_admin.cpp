@@ -23,6 +23,12 @@
 #include "../core/pool_func.hpp"
 #include "../map_func.h"
 #include "../rev.h"
+#include "../vehicle_base.h"
+#include "../station_base.h"
+#include "../performance_counters.h"
+#include "../town.h"
+#include "../industry.h"
+#include "../saveload/saveload.h"
 #include "../game/game.hpp"
 
 
@@ -54,10 +60,66 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_PERFORMANCE
 };
 /** Sanity check. */
 assert_compile(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
 
+/** Maximum number of objects in the answer to a query. */
+static const uint MAX_ADMIN_QUERY_COUNT = 256;
+/** Size of the answer to a query after which no more objects are added to it. */
+static const size_t MAX_ADMIN_QUERY_SIZE = 32 * 1024;
+
+extern const uint16 SAVEGAME_VERSION;
+
+/* The procedures saving a single object, from the savegame code. */
+extern void RealSave_VEHS(Vehicle *v);
+extern void RealSave_STNN(BaseStation *bst);
+extern void RealSave_Town(Town *t);
+extern void RealSave_INDY(Industry *ind);
+extern void SaveLoad_PLYR(Company *c);
+
+/**
+ * Get the size of the pool of a kind of objects.
+ * @tparam T The kind of objects.
+ * @return The size of the pool.
+ */
+template <class T>
+static size_t GetAdminQueryPoolSize()
+{
+	return T::GetPoolSize();
+}
+
+/**
+ * Get an object of a kind of objects.
+ * @tparam T The kind of objects.
+ * @param index The index of the object.
+ * @return The object, or \c NULL when there is no object at the index.
+ */
+template <class T>
+static void *GetAdminQueryObject(size_t index)
+{
+	return T::GetIfValid(index);
+}
+
+/** How to answer queries for a kind of objects. */
+struct AdminQueryPool {
+	size_t (*get_pool_size)();       ///< Get the size of the pool of the objects.
+	void *(*get_object)(size_t);     ///< Get an object of the pool.
+	AutolengthProc *save_proc;       ///< Save an object, like the savegame does.
+};
+
+/** How to answer queries, per #AdminQueryType. */
+static const AdminQueryPool _admin_query_pools[] = {
+	{ &GetAdminQueryPoolSize<Vehicle>,     &GetAdminQueryObject<Vehicle>,     (AutolengthProc *)RealSave_VEHS }, ///< ADMIN_QUERY_VEHICLES
+	{ &GetAdminQueryPoolSize<BaseStation>, &GetAdminQueryObject<BaseStation>, (AutolengthProc *)RealSave_STNN }, ///< ADMIN_QUERY_STATIONS
+	{ &GetAdminQueryPoolSize<Town>,        &GetAdminQueryObject<Town>,        (AutolengthProc *)RealSave_Town }, ///< ADMIN_QUERY_TOWNS
+	{ &GetAdminQueryPoolSize<Industry>,    &GetAdminQueryObject<Industry>,    (AutolengthProc *)RealSave_INDY }, ///< ADMIN_QUERY_INDUSTRIES
+	{ &GetAdminQueryPoolSize<Company>,     &GetAdminQueryObject<Company>,     (AutolengthProc *)SaveLoad_PLYR }, ///< ADMIN_QUERY_COMPANIES
+};
+/** Sanity check. */
+assert_compile(lengthof(_admin_query_pools) == ADMIN_QUERY_END);
+
 /**
  * Create a new socket for the server side of the admin network.
  * @param s The socket to connect with.
@@ -67,6 +129,7 @@ ServerNetworkAdminSocketHandler::ServerNetworkAdminSocketHandler(SOCKET s) : Net
 	_network_admins_connected++;
 	this->status = ADMIN_STATUS_INACTIVE;
 	this->realtime_connect = _realtime_tick;
+	MemSetT(this->performance_sent, 0, ADMIN_PERF_END);
 }
 
 /**
@@ -120,6 +183,44 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
 	as->address = address; // Save the IP of the client
 }
 
+/**
+ * Get the current values of the performance metrics.
+ * @param[out] values The values, indexed by #AdminPerformanceMetric.
+ */
+static void GetAdminPerformanceMetrics(int64 *values)
+{
+	MemSetT(values, 0, ADMIN_PERF_END);
+
+	values[ADMIN_PERF_TICKS]            = _performance_counters.ticks;
+	values[ADMIN_PERF_TICK_TIME]        = _performance_counters.GetTickTime();
+	values[ADMIN_PERF_PATHFINDER_CALLS] = _performance_counters.pathfinder_calls;
+	values[ADMIN_PERF_CARGO_DELIVERED]  = _performance_counters.cargo_delivered;
+
+	const Station *st;
+	FOR_ALL_STATIONS(st) {
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			values[ADMIN_PERF_CARGO_WAITING] += st->goods[c].cargo.Count();
+		}
+	}
+
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (!v->IsPrimaryVehicle()) continue;
+
+		if (v->IsChainInDepot()) {
+			values[ADMIN_PERF_VEHICLES_IN_DEPOT]++;
+		} else if (v->vehstatus & VS_STOPPED) {
+			values[ADMIN_PERF_VEHICLES_STOPPED]++;
+		} else if (v->breakdown_ctr == 1) {
+			values[ADMIN_PERF_VEHICLES_BROKEN_DOWN]++;
+		} else if (v->current_order.IsType(OT_LOADING)) {
+			values[ADMIN_PERF_VEHICLES_LOADING]++;
+		} else {
+			values[ADMIN_PERF_VEHICLES_RUNNING]++;
+		}
+	}
+}
+
 /***********
  * Sending functions for admin network
  ************/
@@ -620,6 +721,119 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdLogging(ClientID clien
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Write a change of a performance metric to a packet, in as few bytes as
+ * small changes need: zigzag encoded, 7 bits per byte.
+ * @param p The packet to write to.
+ * @param delta The change of the metric.
+ */
+static void SendPerformanceDelta(Packet *p, int64 delta)
+{
+	uint64 zigzag = ((uint64)delta << 1) ^ (uint64)(delta >> 63);
+	while (zigzag >= 0x80) {
+		p->Send_uint8((uint8)zigzag | 0x80);
+		zigzag >>= 7;
+	}
+	p->Send_uint8((uint8)zigzag);
+}
+
+/**
+ * Send the changes of the performance metrics since the last performance packet.
+ * @param values The current values of the metrics.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPerformance(const int64 *values)
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_PERFORMANCE);
+
+	uint16 mask = 0;
+	for (uint i = 0; i < ADMIN_PERF_END; i++) {
+		if (values[i] != this->performance_sent[i]) SetBit(mask, i);
+	}
+
+	p->Send_uint32(_frame_counter);
+	p->Send_uint16(mask);
+	for (uint i = 0; i < ADMIN_PERF_END; i++) {
+		if (!HasBit(mask, i)) continue;
+		SendPerformanceDelta(p, values[i] - this->performance_sent[i]);
+		this->performance_sent[i] = values[i];
+	}
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Append an uint32 to the answer of a query, in the byte order of packets.
+ * @param answer The answer.
+ * @param data The value to append.
+ */
+static void AppendAdminQueryUint32(SmallVector<byte, 1024> &answer, uint32 data)
+{
+	byte *b = answer.Append(4);
+	b[0] = GB(data,  0, 8);
+	b[1] = GB(data,  8, 8);
+	b[2] = GB(data, 16, 8);
+	b[3] = GB(data, 24, 8);
+}
+
+/**
+ * Send the state of a range of objects. The whole answer is made first, so
+ * all of it belongs to the same moment of the game; then it is split over
+ * as many packets as needed.
+ * @param type The kind of objects.
+ * @param first The index of the first object to look at.
+ * @param count The maximum number of objects to send.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendQuery(AdminQueryType type, uint32 first, uint count)
+{
+	static ReusableBuffer<byte> object_buffer;
+	const AdminQueryPool &pool = _admin_query_pools[type];
+	count = min(count, MAX_ADMIN_QUERY_COUNT);
+
+	SmallVector<byte, 1024> answer;
+	size_t pool_size = pool.get_pool_size();
+	size_t index = first;
+	for (; index < pool_size && count > 0 && answer.Length() < MAX_ADMIN_QUERY_SIZE; index++) {
+		void *object = pool.get_object(index);
+		if (object == NULL) continue;
+
+		size_t length;
+		const byte *data = SlSaveToBuffer(pool.save_proc, object, &object_buffer, &length);
+		if (data == NULL) {
+			/* The game is being saved; let the admin try again later. */
+			answer.Clear();
+			index = first;
+			break;
+		}
+
+		AppendAdminQueryUint32(answer, (uint32)index);
+		AppendAdminQueryUint32(answer, (uint32)length);
+		MemCpyT(answer.Append((uint)length), data, length);
+		count--;
+	}
+	uint32 next = index < pool_size ? (uint32)index : UINT32_MAX;
+
+	const byte *pos = answer.Begin();
+	const byte *end = answer.End();
+	do {
+		Packet *p = new Packet(ADMIN_PACKET_SERVER_QUERY);
+		p->Send_uint8(type);
+		p->Send_uint32(_frame_counter);
+		p->Send_uint16(SAVEGAME_VERSION);
+		p->Send_uint32(next);
+
+		/* Packets can be filled up to one byte less than the MTU; one byte is left for the last-packet flag. */
+		size_t n = min<size_t>(SEND_MTU - 2 - p->size, end - pos);
+		p->Send_bool(pos + n == end);
+		for (; n > 0; n--) p->Send_uint8(*pos++);
+
+		this->SendPacket(p);
+	} while (pos != end);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /***********
  * Receiving functions
  ************/
@@ -673,6 +887,9 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_UPDATE_FREQUENC
 
 	this->update_frequency[type] = freq;
 
+	/* The next performance packet holds the current values, so the admin knows where the changes start. */
+	if (type == ADMIN_UPDATE_PERFORMANCE) MemSetT(this->performance_sent, 0, ADMIN_PERF_END);
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -735,6 +952,14 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_PERFORMANCE: {
+			/* The admin is requesting the performance counters. */
+			int64 values[ADMIN_PERF_END];
+			GetAdminPerformanceMetrics(values);
+			this->SendPerformance(values);
+			break;
+		}
+
 		default:
 			/* An unsupported "poll" update type. */
 			DEBUG(net, 3, "[admin] Not supported poll %d (%d) from '%s' (%s).", type, d1, this->admin_name, this->admin_version);
@@ -744,6 +969,23 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_QUERY(Packet *p)
+{
+	if (this->status == ADMIN_STATUS_INACTIVE) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
+
+	AdminQueryType type = (AdminQueryType)p->Recv_uint8();
+	uint32 first = p->Recv_uint32();
+	uint16 count = p->Recv_uint16();
+
+	if (type >= ADMIN_QUERY_END) {
+		/* The query is of an unsupported kind of objects. */
+		DEBUG(net, 3, "[admin] Not supported query %d (%d) from '%s' (%s).", type, first, this->admin_name, this->admin_version);
+		return this->SendError(NETWORK_ERROR_ILLEGAL_PACKET);
+	}
+
+	return this->SendQuery(type, first, count);
+}
+
 NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_CHAT(Packet *p)
 {
 	if (this->status == ADMIN_STATUS_INACTIVE) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
@@ -775,6 +1017,31 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_CHAT(Packet *p)
  * Useful wrapper functions
  */
 
+/**
+ * Notify the admin network of the performance counters, every so many ticks
+ * (if they did opt in for the respective update).
+ */
+void NetworkAdminPerformance()
+{
+	if (_frame_counter % max<uint16>(_settings_client.network.admin_performance_interval, 1) != 0) return;
+
+	bool wanted = false;
+	ServerNetworkAdminSocketHandler *as;
+	FOR_ALL_ACTIVE_ADMIN_SOCKETS(as) {
+		if (as->update_frequency[ADMIN_UPDATE_PERFORMANCE] & ADMIN_FREQUENCY_AUTOMATIC) wanted = true;
+	}
+	if (!wanted) return;
+
+	int64 values[ADMIN_PERF_END];
+	GetAdminPerformanceMetrics(values);
+
+	FOR_ALL_ACTIVE_ADMIN_SOCKETS(as) {
+		if (as->update_frequency[ADMIN_UPDATE_PERFORMANCE] & ADMIN_FREQUENCY_AUTOMATIC) {
+			as->SendPerformance(values);
+		}
+	}
+}
+
 /**
  * Notify the admin network of a new client (if they did opt in for the respective update).
  * @param cs the client info.
@@ -1882,6 +1882,8 @@ void NetworkServer_Tick(bool send_frame)
 
 	/* See if we need to advertise */
 	NetworkUDPAdvertise();
+
+	NetworkAdminPerformance();
 }
 
 /** Yearly "callback". Called whenever the year changes. */
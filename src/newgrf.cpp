@@ -48,6 +48,8 @@
 #include "vehicle_func.h"
 #include "language.h"
 #include "vehicle_base.h"
+#include "newgrf_index.h"
+#include "sprite_disk_cache.h"
 
 #include "table/strings.h"
 #include "table/build_industry.h"
@@ -4566,6 +4568,7 @@ static void NewSpriteGroup(ByteReader *buf)
 			}
 
 			group->default_group = GetGroupFromGroupID(setid, type, buf->ReadWord());
+			group->Compile();
 			break;
 		}
 
@@ -8732,6 +8735,7 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 	FioOpenFile(file_index, filename, subdir);
 	_cur.file_index = file_index; // XXX
 	_palette_remap_grf[_cur.file_index] = (config->palette & GRFP_USE_MASK);
+	SetSpriteDiskCacheIdentity(file_index, config->ident.md5sum);
 
 	_cur.grfconfig = config;
 
@@ -8743,10 +8747,13 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 		return;
 	}
 
+	const GRFFileIndex *index = GetGRFFileIndex(filename, subdir);
+	if (index != NULL && index->container_version != _cur.grf_container_ver) index = NULL;
+
 	if (stage == GLS_INIT || stage == GLS_ACTIVATION) {
 		/* We need the sprite offsets in the init stage for NewGRF sounds
 		 * and in the activation stage for real sprites. */
-		ReadGRFSpriteOffsets(_cur.grf_container_ver);
+		ReadGRFSpriteOffsets(_cur.grf_container_ver, index != NULL ? &index->sprite_offsets : NULL);
 	} else {
 		/* Skip sprite section offset if present. */
 		if (_cur.grf_container_ver >= 2) FioReadDword();
@@ -8803,7 +8810,7 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 				FioSkipBytes(num);
 			} else {
 				FioSkipBytes(7);
-				SkipSpriteData(type, num - 8);
+				if (index == NULL || !index->SkipRealSprite(FioGetPos())) SkipSpriteData(type, num - 8);
 			}
 		}
 
@@ -9105,6 +9112,15 @@ void LoadNewGRF(uint load_index, uint file_index)
 
 	_cur.spriteid = load_index;
 
+	/* Index the sprites of all files on worker threads, so the loading
+	 * stages below do not have to walk the data of every real sprite. */
+	uint slot = file_index;
+	for (GRFConfig *c = _grfconfig; c != NULL; c = c->next) {
+		if (c->status == GCS_DISABLED || c->status == GCS_NOT_FOUND) continue;
+		AddGRFFileToIndex(c->filename, slot++ == file_index ? BASESET_DIR : NEWGRF_DIR);
+	}
+	BuildGRFFileIndices();
+
 	/* Load newgrf sprites
 	 * in each loading stage, (try to) open each file specified in the config
 	 * and load information from it. */
@@ -9126,7 +9142,7 @@ void LoadNewGRF(uint load_index, uint file_index)
 			}
 		}
 
-		uint slot = file_index;
+		slot = file_index;
 
 		_cur.stage = stage;
 		for (GRFConfig *c = _grfconfig; c != NULL; c = c->next) {
@@ -9159,6 +9175,7 @@ void LoadNewGRF(uint load_index, uint file_index)
 
 	/* Pseudo sprite processing is finished; free temporary stuff */
 	_cur.ClearDataForNextFile();
+	ClearGRFFileIndices();
 
 	/* Call any functions that should be run after GRFs have been loaded. */
 	AfterLoadGRFs();
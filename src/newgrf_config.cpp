@@ -21,10 +21,15 @@
 #include "video/video_driver.hpp"
 #include "strings_func.h"
 #include "textfile_gui.h"
+#include "thread/thread.h"
+#include "core/string_compare_type.hpp"
 
 #include "fileio_func.h"
 #include "fios.h"
 
+#include <map>
+#include <sys/stat.h>
+
 /** Create a new GRFTextWrapper. */
 GRFTextWrapper::GRFTextWrapper() :
 	text(NULL)
@@ -377,13 +382,13 @@ static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
 
 
 /**
- * Find the GRFID of a given grf, and calculate its md5sum.
+ * Find the GRFID and the other Action 8 and 14 information of a given grf.
  * @param config    grf to fill.
  * @param is_static grf is static.
  * @param subdir    the subdirectory to search in.
- * @return Operation was successfully completed.
+ * @return The grf can be used, after its md5sum is calculated.
  */
-bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
+static bool ReadGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
 {
 	if (!FioCheckFileExists(config->filename, subdir)) {
 		config->status = GCS_NOT_FOUND;
@@ -406,7 +411,19 @@ bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
 		if (HasBit(config->flags, GCF_UNSAFE)) return false;
 	}
 
-	return CalcGRFMD5Sum(config, subdir);
+	return true;
+}
+
+/**
+ * Find the GRFID of a given grf, and calculate its md5sum.
+ * @param config    grf to fill.
+ * @param is_static grf is static.
+ * @param subdir    the subdirectory to search in.
+ * @return Operation was successfully completed.
+ */
+bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
+{
+	return ReadGRFDetails(config, is_static, subdir) && CalcGRFMD5Sum(config, subdir);
 }
 
 
@@ -597,36 +614,491 @@ compatible_grf:
 	return res;
 }
 
+char *_newgrf_cache_file; ///< The file the details of the scanned NewGRFs are cached in.
+
+/** Magic bytes at the start of the NewGRF scan cache. */
+static const char GRF_SCAN_CACHE_MAGIC[4] = { 'O', 'G', 'S', 'C' };
+/** Version of the NewGRF scan cache format; bump when the cached details of a #GRFConfig change. */
+static const byte GRF_SCAN_CACHE_VERSION = 1;
+/** Maximum number of threads used for calculating the md5sums of the scanned NewGRFs. */
+static const uint MAX_GRF_MD5_THREADS = 8;
+
+/** A file as it is stored in the NewGRF scan cache. */
+struct GRFScanCacheItem {
+	uint64 size;       ///< Size of the file when it was scanned.
+	int64 mtime;       ///< Modification time of the file when it was scanned.
+	GRFConfig *config; ///< The details of the file, or \c NULL when it is not a NewGRF that can be used.
+};
+
+/** The files of the NewGRF scan cache by their key, see #GRFScanResult::key. */
+typedef std::map<const char *, GRFScanCacheItem, StringCompare> GRFScanCache;
+
+/** A file found while scanning for NewGRFs. */
+struct GRFScanResult {
+	char *key;         ///< Full path of the file; files in a tar are prefixed by the path of the tar.
+	uint64 size;       ///< Size of the file, or of the tar it is in.
+	int64 mtime;       ///< Modification time of the file, or of the tar it is in.
+	bool cacheable;    ///< Whether the size and modification time are known, so the result can be cached.
+	bool needs_md5sum; ///< Whether the md5sum of the file still has to be calculated.
+	GRFConfig *config; ///< The details of the file, or \c NULL when it is not a NewGRF that can be used.
+};
+
+/**
+ * Get the size and modification time of a file.
+ * @param filename The file.
+ * @param size [out] The size of the file.
+ * @param mtime [out] The modification time of the file.
+ * @return False when the file could not be found.
+ */
+static bool GetGRFFileStats(const char *filename, uint64 *size, int64 *mtime)
+{
+#ifdef WIN32
+	struct _stat sb;
+	if (_tstat(OTTD2FS(filename), &sb) != 0) return false;
+#else
+	struct stat sb;
+	if (stat(filename, &sb) != 0) return false;
+#endif
+	*size = sb.st_size;
+	*mtime = sb.st_mtime;
+	return true;
+}
+
+/** Reader of the NewGRF scan cache; it remembers whether anything could not be read. */
+struct GRFScanCacheReader {
+	FILE *f; ///< The cache file.
+	bool ok; ///< Whether everything could be read so far.
+
+	/**
+	 * Create a reader.
+	 * @param f The cache file.
+	 */
+	GRFScanCacheReader(FILE *f) : f(f), ok(true) {}
+
+	/**
+	 * Read some bytes; they are zeroed when they cannot be read.
+	 * @param buffer Destination of the bytes.
+	 * @param len The number of bytes.
+	 */
+	void ReadBytes(void *buffer, size_t len)
+	{
+		if (this->ok && fread(buffer, 1, len, this->f) == len) return;
+		this->ok = false;
+		memset(buffer, 0, len);
+	}
+
+	/**
+	 * Read a byte.
+	 * @return The read byte.
+	 */
+	byte ReadByte()
+	{
+		byte b;
+		this->ReadBytes(&b, 1);
+		return b;
+	}
+
+	/**
+	 * Read a double word (32 bits) in little endian format.
+	 * @return The read double word.
+	 */
+	uint32 ReadDword()
+	{
+		byte b[4];
+		this->ReadBytes(b, sizeof(b));
+		return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32)b[3] << 24);
+	}
+
+	/**
+	 * Read a quad word (64 bits) in little endian format.
+	 * @return The read quad word.
+	 */
+	uint64 ReadQword()
+	{
+		uint64 low = this->ReadDword();
+		return low | ((uint64)this->ReadDword() << 32);
+	}
+
+	/**
+	 * Read a string.
+	 * @return The read string, or \c NULL on failure.
+	 */
+	char *ReadString()
+	{
+		uint32 len = this->ReadDword();
+		if (!this->ok || len > MAX_PATH * 4) {
+			this->ok = false;
+			return NULL;
+		}
+
+		char *str = MallocT<char>(len + 1);
+		this->ReadBytes(str, len);
+		str[len] = '\0';
+		return str;
+	}
+
+	/**
+	 * Read a list of texts.
+	 * @return The read list; on failure the texts that could be read.
+	 */
+	GRFText *ReadTextList()
+	{
+		GRFText *list = NULL;
+		if (this->ok) this->ok = LoadGRFTextList(this->f, &list);
+		return list;
+	}
+};
+
+/**
+ * Write a double word (32 bits) in little endian format to the NewGRF scan cache.
+ * @param f The cache file.
+ * @param value The double word.
+ */
+static void WriteGRFScanCacheDword(FILE *f, uint32 value)
+{
+	for (uint i = 0; i < 4; i++) fputc(GB(value, i * 8, 8), f);
+}
+
+/**
+ * Write a quad word (64 bits) in little endian format to the NewGRF scan cache.
+ * @param f The cache file.
+ * @param value The quad word.
+ */
+static void WriteGRFScanCacheQword(FILE *f, uint64 value)
+{
+	WriteGRFScanCacheDword(f, GB(value, 0, 32));
+	WriteGRFScanCacheDword(f, GB(value, 32, 32));
+}
+
+/**
+ * Write the details of a NewGRF, as found by #FillGRFDetails, to the NewGRF scan cache.
+ * @param f The cache file.
+ * @param c The details to write.
+ */
+static void WriteGRFScanCacheConfig(FILE *f, const GRFConfig *c)
+{
+	WriteGRFScanCacheDword(f, c->ident.grfid);
+	fwrite(c->ident.md5sum, 1, sizeof(c->ident.md5sum), f);
+	WriteGRFScanCacheDword(f, c->version);
+	WriteGRFScanCacheDword(f, c->min_loadable_version);
+	fputc(c->flags, f);
+	fputc(c->palette, f);
+	fputc(c->num_params, f);
+	for (uint i = 0; i < c->num_params; i++) WriteGRFScanCacheDword(f, c->param[i]);
+	fputc(c->num_valid_params, f);
+	fputc(c->has_param_defaults ? 1 : 0, f);
+	SaveGRFTextList(f, c->name->text);
+	SaveGRFTextList(f, c->info->text);
+	SaveGRFTextList(f, c->url->text);
+
+	WriteGRFScanCacheDword(f, c->param_info.Length());
+	for (const GRFParameterInfo * const *it = c->param_info.Begin(); it != c->param_info.End(); it++) {
+		const GRFParameterInfo *info = *it;
+		fputc(info != NULL ? 1 : 0, f);
+		if (info == NULL) continue;
+
+		SaveGRFTextList(f, info->name);
+		SaveGRFTextList(f, info->desc);
+		fputc(info->type, f);
+		WriteGRFScanCacheDword(f, info->min_value);
+		WriteGRFScanCacheDword(f, info->max_value);
+		WriteGRFScanCacheDword(f, info->def_value);
+		fputc(info->param_nr, f);
+		fputc(info->first_bit, f);
+		fputc(info->num_bit, f);
+		fputc(info->complete_labels ? 1 : 0, f);
+		WriteGRFScanCacheDword(f, info->value_names.Length());
+		for (const SmallPair<uint32, GRFText *> *name = info->value_names.Begin(); name != info->value_names.End(); name++) {
+			WriteGRFScanCacheDword(f, name->first);
+			SaveGRFTextList(f, name->second);
+		}
+	}
+}
+
+/**
+ * Read the details of a NewGRF that were written by #WriteGRFScanCacheConfig.
+ * @param reader The reader of the cache file.
+ * @return The details, or \c NULL when they could not be read.
+ */
+static GRFConfig *ReadGRFScanCacheConfig(GRFScanCacheReader &reader)
+{
+	GRFConfig *c = new GRFConfig();
+	c->ident.grfid = reader.ReadDword();
+	reader.ReadBytes(c->ident.md5sum, sizeof(c->ident.md5sum));
+	c->version = reader.ReadDword();
+	c->min_loadable_version = reader.ReadDword();
+	c->flags = reader.ReadByte();
+	c->palette = reader.ReadByte();
+	c->num_params = reader.ReadByte();
+	if (c->num_params > lengthof(c->param)) reader.ok = false;
+	for (uint i = 0; reader.ok && i < c->num_params; i++) c->param[i] = reader.ReadDword();
+	c->num_valid_params = reader.ReadByte();
+	c->has_param_defaults = reader.ReadByte() != 0;
+	c->name->text = reader.ReadTextList();
+	c->info->text = reader.ReadTextList();
+	c->url->text = reader.ReadTextList();
+
+	uint32 num_infos = reader.ReadDword();
+	if (num_infos > lengthof(c->param)) reader.ok = false;
+	for (uint i = 0; reader.ok && i < num_infos; i++) {
+		if (reader.ReadByte() == 0) {
+			*c->param_info.Append() = NULL;
+			continue;
+		}
+
+		GRFParameterInfo *info = new GRFParameterInfo(i);
+		*c->param_info.Append() = info;
+		info->name = reader.ReadTextList();
+		info->desc = reader.ReadTextList();
+		info->type = (GRFParameterType)reader.ReadByte();
+		if (info->type >= PTYPE_END) reader.ok = false;
+		info->min_value = reader.ReadDword();
+		info->max_value = reader.ReadDword();
+		info->def_value = reader.ReadDword();
+		info->param_nr = reader.ReadByte();
+		info->first_bit = reader.ReadByte();
+		info->num_bit = reader.ReadByte();
+		info->complete_labels = reader.ReadByte() != 0;
+
+		uint32 num_names = reader.ReadDword();
+		for (uint j = 0; reader.ok && j < num_names; j++) {
+			uint32 value = reader.ReadDword();
+			info->value_names.Insert(value, reader.ReadTextList());
+		}
+	}
+
+	if (!reader.ok) {
+		delete c;
+		return NULL;
+	}
+	return c;
+}
+
+/**
+ * Read the NewGRF scan cache, as written after the previous scan.
+ * @param cache [out] The files of the cache.
+ */
+static void LoadGRFScanCache(GRFScanCache &cache)
+{
+	if (_newgrf_cache_file == NULL) return;
+
+	FILE *f = fopen(_newgrf_cache_file, "rb");
+	if (f == NULL) return;
+
+	char magic[sizeof(GRF_SCAN_CACHE_MAGIC)];
+	if (fread(magic, 1, sizeof(magic), f) == sizeof(magic) && memcmp(magic, GRF_SCAN_CACHE_MAGIC, sizeof(magic)) == 0 && fgetc(f) == GRF_SCAN_CACHE_VERSION) {
+		GRFScanCacheReader reader(f);
+		uint32 count = reader.ReadDword();
+		for (uint32 i = 0; reader.ok && i < count; i++) {
+			char *key = reader.ReadString();
+			GRFScanCacheItem item;
+			item.size = reader.ReadQword();
+			item.mtime = reader.ReadQword();
+			item.config = (reader.ReadByte() != 0 && reader.ok) ? ReadGRFScanCacheConfig(reader) : NULL;
+
+			if (!reader.ok || cache.find(key) != cache.end()) {
+				free(key);
+				delete item.config;
+				continue;
+			}
+			cache[key] = item;
+		}
+		DEBUG(grf, 2, "Read %u NewGRFs from the scan cache", (uint)cache.size());
+	}
+
+	fclose(f);
+}
+
+/** The scanned files to calculate the md5sum of. */
+struct GRFMD5SumJob {
+	GRFScanResult *results; ///< All scanned files.
+	uint count;             ///< Number of scanned files.
+};
+
+/**
+ * Calculate the md5sums of one part of the files.
+ * @param part The part to do.
+ * @param parts The number of parts.
+ * @param data The #GRFMD5SumJob.
+ */
+static void CalcGRFMD5SumsPart(uint part, uint parts, void *data)
+{
+	const GRFMD5SumJob *job = (const GRFMD5SumJob *)data;
+	for (uint i = part; i < job->count; i += parts) {
+		GRFScanResult *r = &job->results[i];
+		if (r->needs_md5sum && CalcGRFMD5Sum(r->config, NEWGRF_DIR)) r->needs_md5sum = false;
+	}
+}
+
 /** Helper for scanning for files with GRF as extension */
 class GRFFileScanner : FileScanner {
 	uint next_update; ///< The next (realtime tick) we do update the screen.
 	uint num_scanned; ///< The number of GRFs we have scanned.
+	GRFScanCache cache;                     ///< The files found by the previous scan.
+	SmallVector<GRFScanResult, 32> results; ///< The files found by this scan, in the order they were found.
+
+	void CalcMD5Sums();
+	void SaveCache() const;
+	uint AddToList();
 
 public:
 	GRFFileScanner() : next_update(_realtime_tick), num_scanned(0)
 	{
+		LoadGRFScanCache(this->cache);
 	}
 
+	~GRFFileScanner();
+
 	/* virtual */ bool AddFile(const char *filename, size_t basepath_length, const char *tar_filename);
 
 	/** Do the scan for GRFs. */
 	static uint DoScan()
 	{
 		GRFFileScanner fs;
-		int ret = fs.Scan(".grf", NEWGRF_DIR);
+		fs.Scan(".grf", NEWGRF_DIR);
+		fs.CalcMD5Sums();
+		fs.SaveCache();
 		/* The number scanned and the number returned may not be the same;
 		 * duplicate NewGRFs and base sets are ignored in the return value. */
 		_settings_client.gui.last_newgrf_count = fs.num_scanned;
-		return ret;
+		return fs.AddToList();
 	}
 };
 
+/** Free the files of both the previous and this scan. */
+GRFFileScanner::~GRFFileScanner()
+{
+	for (GRFScanCache::iterator it = this->cache.begin(); it != this->cache.end(); it++) {
+		free(it->first);
+		delete it->second.config;
+	}
+	for (GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		free(r->key);
+		delete r->config;
+	}
+}
+
 bool GRFFileScanner::AddFile(const char *filename, size_t basepath_length, const char *tar_filename)
 {
-	GRFConfig *c = new GRFConfig(filename + basepath_length);
+	GRFScanResult *r = this->results.Append();
+	r->key = (tar_filename == NULL) ? strdup(filename) : str_fmt("%s%c%s", tar_filename, PATHSEPCHAR, filename);
+	r->cacheable = GetGRFFileStats(tar_filename == NULL ? filename : tar_filename, &r->size, &r->mtime);
+	r->needs_md5sum = false;
+	r->config = NULL;
+
+	GRFScanCache::const_iterator it = this->cache.find(r->key);
+	if (r->cacheable && it != this->cache.end() && it->second.size == r->size && it->second.mtime == r->mtime) {
+		/* Unchanged since the previous scan, so what was found then still holds. */
+		if (it->second.config != NULL) {
+			r->config = new GRFConfig(*it->second.config);
+			r->config->filename = strdup(filename + basepath_length);
+		}
+	} else {
+		GRFConfig *c = new GRFConfig(filename + basepath_length);
+		if (ReadGRFDetails(c, false, NEWGRF_DIR)) {
+			r->config = c;
+			r->needs_md5sum = true;
+		} else {
+			delete c;
+		}
+	}
+
+	this->num_scanned++;
+	if (this->next_update <= _realtime_tick) {
+		_modal_progress_work_mutex->EndCritical();
+		_modal_progress_paint_mutex->BeginCritical();
+
+		const char *name = NULL;
+		if (r->config != NULL && r->config->name != NULL) name = GetGRFStringFromGRFText(r->config->name->text);
+		if (name == NULL) name = filename + basepath_length;
+		UpdateNewGRFScanStatus(this->num_scanned, name);
+
+		_modal_progress_work_mutex->BeginCritical();
+		_modal_progress_paint_mutex->EndCritical();
+
+		this->next_update = _realtime_tick + 200;
+	}
+
+	return r->config != NULL;
+}
+
+/**
+ * Calculate the md5sums of the files that were not in the scan cache, spread over as many threads as there are cores.
+ * Files of which the md5sum cannot be calculated are forgotten.
+ */
+void GRFFileScanner::CalcMD5Sums()
+{
+	uint todo = 0;
+	for (const GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		if (r->needs_md5sum) todo++;
+	}
+	if (todo == 0) return;
+
+	uint num_threads = Clamp(GetCPUCoreCount(), 1U, min(MAX_GRF_MD5_THREADS, todo));
+	DEBUG(grf, 2, "Calculating the md5sums of %u NewGRFs on %u threads", todo, num_threads);
+
+	GRFMD5SumJob job;
+	job.results = this->results.Begin();
+	job.count = this->results.Length();
+	RunParallel(num_threads, &CalcGRFMD5SumsPart, &job);
+
+	for (GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		if (!r->needs_md5sum) continue;
+
+		delete r->config;
+		r->config = NULL;
+		r->needs_md5sum = false;
+		r->cacheable = false;
+	}
+}
+
+/** Write the files found by this scan to the NewGRF scan cache, for the next scan. */
+void GRFFileScanner::SaveCache() const
+{
+	if (_newgrf_cache_file == NULL) return;
+
+	FILE *f = fopen(_newgrf_cache_file, "wb");
+	if (f == NULL) {
+		DEBUG(grf, 1, "Could not write the NewGRF scan cache to %s", _newgrf_cache_file);
+		return;
+	}
+
+	uint count = 0;
+	for (const GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		if (r->cacheable) count++;
+	}
+
+	fwrite(GRF_SCAN_CACHE_MAGIC, 1, sizeof(GRF_SCAN_CACHE_MAGIC), f);
+	fputc(GRF_SCAN_CACHE_VERSION, f);
+	WriteGRFScanCacheDword(f, count);
+	for (const GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		if (!r->cacheable) continue;
+
+		size_t len = strlen(r->key);
+		WriteGRFScanCacheDword(f, len);
+		fwrite(r->key, 1, len, f);
+		WriteGRFScanCacheQword(f, r->size);
+		WriteGRFScanCacheQword(f, r->mtime);
+		fputc(r->config != NULL ? 1 : 0, f);
+		if (r->config != NULL) WriteGRFScanCacheConfig(f, r->config);
+	}
+
+	fclose(f);
+}
+
+/**
+ * Add the NewGRFs found by this scan to #_all_grfs, in the order they were found.
+ * @return The number of added NewGRFs.
+ */
+uint GRFFileScanner::AddToList()
+{
+	uint num = 0;
+	for (GRFScanResult *r = this->results.Begin(); r != this->results.End(); r++) {
+		GRFConfig *c = r->config;
+		if (c == NULL) continue;
+		r->config = NULL;
 
-	bool added = true;
-	if (FillGRFDetails(c, false)) {
+		bool added = true;
 		if (_all_grfs == NULL) {
 			_all_grfs = c;
 		} else {
@@ -650,33 +1122,15 @@ bool GRFFileScanner::AddFile(const char *filename, size_t basepath_length, const
 				*pd = c;
 			}
 		}
-	} else {
-		added = false;
-	}
-
-	this->num_scanned++;
-	if (this->next_update <= _realtime_tick) {
-		_modal_progress_work_mutex->EndCritical();
-		_modal_progress_paint_mutex->BeginCritical();
-
-		const char *name = NULL;
-		if (c->name != NULL) name = GetGRFStringFromGRFText(c->name->text);
-		if (name == NULL) name = c->filename;
-		UpdateNewGRFScanStatus(this->num_scanned, name);
 
-		_modal_progress_work_mutex->BeginCritical();
-		_modal_progress_paint_mutex->EndCritical();
-
-		this->next_update = _realtime_tick + 200;
-	}
-
-	if (!added) {
-		/* File couldn't be opened, or is either not a NewGRF or is a
-		 * 'system' NewGRF or it's already known, so forget about it. */
-		delete c;
+		if (added) {
+			num++;
+		} else {
+			/* The NewGRF is already known, so forget about it. */
+			delete c;
+		}
 	}
-
-	return added;
+	return num;
 }
 
 /**
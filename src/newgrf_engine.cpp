@@ -362,7 +362,11 @@ static byte MapAircraftMovementAction(const Aircraft *v)
 	 * other time is an error. */
 	assert(this->ro->trigger != 0);
 
-	if (v != NULL) v->waiting_triggers = triggers;
+	if (v != NULL && v->waiting_triggers != triggers) {
+		v->waiting_triggers = triggers;
+		/* Callback results may depend on the waiting triggers. */
+		v->InvalidateNewGRFCallbackCache();
+	}
 }
 
 
@@ -463,6 +467,57 @@ static uint32 PositionHelper(const Vehicle *v, bool consecutive)
 	return chain_before | chain_after << 8 | (chain_before + chain_after + consecutive) << 16;
 }
 
+/**
+ * Look up the remembered result of a variable of a vehicle.
+ * @param v The vehicle.
+ * @param variable The variable.
+ * @param parameter The parameter of the variable.
+ * @param[out] value The remembered result.
+ * @return Whether the result was remembered in this tick.
+ */
+static bool GetMemoisedVariable(Vehicle *v, byte variable, uint32 parameter, uint32 *value)
+{
+	NewGRFVariableMemo *memo = &v->grf_memo;
+	if (memo->tick != _tick_counter) {
+		memo->tick = _tick_counter;
+		memo->count = 0;
+		return false;
+	}
+
+	for (uint i = 0; i < memo->count; i++) {
+		if (memo->entries[i].variable == variable && memo->entries[i].parameter == parameter) {
+			*value = memo->entries[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Remember the result of a variable of a vehicle for the rest of the tick.
+ * @param v The vehicle.
+ * @param variable The variable.
+ * @param parameter The parameter of the variable.
+ * @param value The result.
+ * @return The result.
+ */
+static uint32 MemoiseVariable(Vehicle *v, byte variable, uint32 parameter, uint32 value)
+{
+	NewGRFVariableMemo *memo = &v->grf_memo;
+	NewGRFVariableMemo::Entry *entry;
+	if (memo->count < NEWGRF_VARIABLE_MEMO_SIZE) {
+		entry = &memo->entries[memo->count++];
+	} else {
+		entry = &memo->entries[memo->next];
+		memo->next = (memo->next + 1) % NEWGRF_VARIABLE_MEMO_SIZE;
+	}
+
+	entry->variable  = variable;
+	entry->parameter = parameter;
+	entry->value     = value;
+	return value;
+}
+
 static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object, byte variable, uint32 parameter, bool *available)
 {
 	/* Calculated vehicle parameters */
@@ -632,11 +687,15 @@ static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object,
 			if (v->type != VEH_TRAIN) return v->GetEngine()->grf_prop.local_id == parameter ? 1 : 0;
 
 			{
-				uint count = 0;
-				for (; v != NULL; v = v->Next()) {
-					if (v->GetEngine()->grf_prop.local_id == parameter) count++;
+				/* The count only depends on the vehicles in the consist, so any change invalidates it together with the NewGRF cache. */
+				uint32 count;
+				if (GetMemoisedVariable(v, variable, parameter, &count)) return count;
+
+				count = 0;
+				for (const Vehicle *u = v; u != NULL; u = u->Next()) {
+					if (u->GetEngine()->grf_prop.local_id == parameter) count++;
 				}
-				return count;
+				return MemoiseVariable(v, variable, parameter, count);
 			}
 
 		case 0x61: // Get variable of n-th vehicle in chain [signed number relative to vehicle]
@@ -1096,6 +1155,77 @@ uint16 GetVehicleCallbackParent(CallbackID callback, uint32 param1, uint32 param
 	return group->GetCallbackResult();
 }
 
+uint32 _vehicle_callback_cache_generation; ///< Generation of the callback caches of the vehicles; a cache of another generation is outdated.
+
+/**
+ * Evaluate a newgrf callback for a vehicle, reusing its result when the
+ * vehicle already evaluated the callback since the last change.
+ * @param callback The callback to evaluate.
+ * @param param1   First parameter of the callback.
+ * @param v        The vehicle to evaluate the callback for.
+ * @return The value the callback returned, or CALLBACK_FAILED if it failed.
+ * @see NewGRFCallbackCache
+ */
+static uint16 GetCachedVehicleCallback(CallbackID callback, uint32 param1, const Vehicle *v)
+{
+	NewGRFCallbackCache *cache = &const_cast<Vehicle *>(v)->grf_callback_cache;
+	if (cache->generation != _vehicle_callback_cache_generation) {
+		cache->generation = _vehicle_callback_cache_generation;
+		cache->count = 0;
+	}
+
+	for (uint i = 0; i < cache->count; i++) {
+		if (cache->entries[i].callback == callback && cache->entries[i].param1 == param1) return cache->entries[i].result;
+	}
+
+	uint16 result = GetVehicleCallback(callback, param1, 0, v->engine_type, v);
+
+	NewGRFCallbackCache::Entry *entry;
+	if (cache->count < NEWGRF_CALLBACK_CACHE_SIZE) {
+		entry = &cache->entries[cache->count++];
+	} else {
+		entry = &cache->entries[cache->next];
+		cache->next = (cache->next + 1) % NEWGRF_CALLBACK_CACHE_SIZE;
+	}
+	entry->callback = callback;
+	entry->param1   = param1;
+	entry->result   = result;
+	return result;
+}
+
+/**
+ * Resolve the sprite and a few callbacks of all vehicles with a NewGRF engine,
+ * to measure how fast the action 2 chains of the loaded NewGRFs resolve.
+ * @param iterations Number of times to resolve everything.
+ * @param[out] resolves Number of resolved chains.
+ * @return Checksum of all results, to check whether different builds resolve the same.
+ */
+uint32 BenchmarkVehicleResolving(uint iterations, uint *resolves)
+{
+	uint32 checksum = 0;
+	*resolves = 0;
+
+	for (uint i = 0; i < iterations; i++) {
+		const Vehicle *v;
+		FOR_ALL_VEHICLES(v) {
+			if (v->type > VEH_AIRCRAFT || v->GetGRF() == NULL) continue;
+			if (v->type == VEH_AIRCRAFT && !Aircraft::From(v)->IsNormalAircraft()) continue;
+
+			uint32 results[] = {
+				v->GetImage(v->direction, EIT_ON_MAP),
+				GetVehicleCallback(CBID_VEHICLE_LOAD_AMOUNT, 0, 0, v->engine_type, v),
+				GetVehicleCallback(CBID_VEHICLE_COLOUR_MAPPING, 0, 0, v->engine_type, v),
+			};
+			for (uint j = 0; j < lengthof(results); j++) {
+				checksum = ROL(checksum, 5) ^ results[j];
+			}
+			*resolves += lengthof(results);
+		}
+	}
+
+	return checksum;
+}
+
 
 /* Callback 36 handlers */
 uint GetVehicleProperty(const Vehicle *v, PropertyID property, uint orig_value)
@@ -1106,7 +1236,10 @@ uint GetVehicleProperty(const Vehicle *v, PropertyID property, uint orig_value)
 
 uint GetEngineProperty(EngineID engine, PropertyID property, uint orig_value, const Vehicle *v)
 {
-	uint16 callback = GetVehicleCallback(CBID_VEHICLE_MODIFY_PROPERTY, property, 0, engine, v);
+	/* Properties are queried often, e.g. for every vehicle of a consist whenever its cargo changes, so reuse the results of a vehicle. */
+	uint16 callback = (v != NULL && v->engine_type == engine) ?
+			GetCachedVehicleCallback(CBID_VEHICLE_MODIFY_PROPERTY, property, v) :
+			GetVehicleCallback(CBID_VEHICLE_MODIFY_PROPERTY, property, 0, engine, v);
 	if (callback != CALLBACK_FAILED) return callback;
 
 	return orig_value;
@@ -1128,6 +1261,8 @@ static void DoTriggerVehicle(Vehicle *v, VehicleTrigger trigger, byte base_rando
 	uint32 reseed = object.GetReseedSum(); // The scope only affects triggers, not the reseeding
 	v->random_bits &= ~reseed;
 	v->random_bits |= (first ? new_random_bits : base_random_bits) & reseed;
+	/* Callback results may depend on the random bits. */
+	v->InvalidateNewGRFCallbackCache();
 
 	switch (trigger) {
 		case VEHICLE_TRIGGER_NEW_CARGO:
@@ -1139,6 +1274,7 @@ static void DoTriggerVehicle(Vehicle *v, VehicleTrigger trigger, byte base_rando
 			 * i.e.), so we give them all the NEW_CARGO triggered
 			 * vehicle's portion of random bits. */
 			assert(first);
+			v->First()->InvalidateNewGRFCallbackCache();
 			DoTriggerVehicle(v->First(), VEHICLE_TRIGGER_ANY_NEW_CARGO, new_random_bits, false);
 			break;
 
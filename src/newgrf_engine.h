@@ -72,6 +72,20 @@ void SetEngineGRF(EngineID engine, const struct GRFFile *file);
 
 uint16 GetVehicleCallback(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v);
 uint16 GetVehicleCallbackParent(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v, const Vehicle *parent);
+uint32 BenchmarkVehicleResolving(uint iterations, uint *resolves);
+
+extern uint32 _vehicle_callback_cache_generation;
+
+/**
+ * Forget the remembered callback results of all vehicles. This happens
+ * at the start of every tick and before every command, so results
+ * remembered outside of the game loop, like by the GUI, are never used
+ * by the game state.
+ */
+static inline void InvalidateVehicleCallbackCaches()
+{
+	_vehicle_callback_cache_generation++;
+}
 bool UsesWagonOverride(const Vehicle *v);
 #define GetCustomVehicleSprite(v, direction, image_type) GetCustomEngineSprite(v->engine_type, v, direction, image_type)
 #define GetCustomVehicleIcon(et, direction, image_type) GetCustomEngineSprite(et, NULL, direction, image_type)
@@ -0,0 +1,285 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_index.cpp Index of the sprites in NewGRF files, built in parallel before loading them. */
+
+#include "stdafx.h"
+#include "fileio_func.h"
+#include "core/smallvec_type.hpp"
+#include "thread/thread.h"
+#include "newgrf_index.h"
+
+extern const byte _grf_cont_v2_sig[8];
+
+/** Maximum number of threads used for indexing the files. */
+static const uint MAX_GRF_INDEX_THREADS = 8;
+
+/** The indices of the files that are being loaded. */
+static AutoDeleteSmallVector<GRFFileIndex *, 32> _grf_file_indices;
+
+/**
+ * Buffered reader of a file with its own file handle. Reads past the
+ * end of the file return 0, like the Fio functions, but are remembered.
+ */
+class GRFIndexReader {
+	FILE *f;                ///< The file to read from.
+	size_t pos;             ///< Position in the file of #buffer_end.
+	byte *buffer_pos;       ///< The next byte to read in the buffer.
+	byte *buffer_end;       ///< The end of the valid data in the buffer.
+	byte buffer[4096];      ///< The read data.
+
+public:
+	bool eof;               ///< Whether we tried to read past the end of the file.
+
+	/**
+	 * Create a reader at the current position of a file.
+	 * @param f The file to read from.
+	 */
+	GRFIndexReader(FILE *f) : f(f), pos(ftell(f)), buffer_pos(buffer), buffer_end(buffer), eof(false) {}
+
+	/**
+	 * Get the position in the file.
+	 * @return The position of the next byte to read.
+	 */
+	inline size_t GetPos() const
+	{
+		return this->pos - (this->buffer_end - this->buffer_pos);
+	}
+
+	/**
+	 * Continue reading at another position.
+	 * @param pos The new position in the file.
+	 */
+	void Seek(size_t pos)
+	{
+		this->buffer_pos = this->buffer_end = this->buffer;
+		this->pos = pos;
+		fseek(this->f, pos, SEEK_SET);
+	}
+
+	/**
+	 * Skip some bytes.
+	 * @param n The number of bytes to skip.
+	 */
+	void Skip(size_t n)
+	{
+		if (n <= (size_t)(this->buffer_end - this->buffer_pos)) {
+			this->buffer_pos += n;
+		} else {
+			this->Seek(this->GetPos() + n);
+		}
+	}
+
+	/**
+	 * Read a byte.
+	 * @return The read byte.
+	 */
+	inline byte ReadByte()
+	{
+		if (this->buffer_pos == this->buffer_end) {
+			size_t size = fread(this->buffer, 1, sizeof(this->buffer), this->f);
+			this->pos += size;
+			this->buffer_pos = this->buffer;
+			this->buffer_end = this->buffer + size;
+			if (size == 0) {
+				this->eof = true;
+				return 0;
+			}
+		}
+		return *this->buffer_pos++;
+	}
+
+	/**
+	 * Read a word (16 bits) in little endian format.
+	 * @return The read word.
+	 */
+	uint16 ReadWord()
+	{
+		byte b = this->ReadByte();
+		return (this->ReadByte() << 8) | b;
+	}
+
+	/**
+	 * Read a double word (32 bits) in little endian format.
+	 * @return The read double word.
+	 */
+	uint32 ReadDword()
+	{
+		uint b = this->ReadWord();
+		return (this->ReadWord() << 16) | b;
+	}
+
+	/**
+	 * Skip the graphics data of a real sprite, like #SkipSpriteData.
+	 * @param type The type of the sprite.
+	 * @param num The size of the data.
+	 */
+	void SkipSpriteData(byte type, uint16 num)
+	{
+		if (type & 2) {
+			this->Skip(num);
+			return;
+		}
+
+		while (num > 0) {
+			int8 i = this->ReadByte();
+			if (i >= 0) {
+				int size = (i == 0) ? 0x80 : i;
+				if (size > num) return;
+				num -= size;
+				this->Skip(size);
+			} else {
+				i = -(i >> 3);
+				num -= i;
+				this->ReadByte();
+			}
+		}
+	}
+};
+
+/**
+ * Index the file by walking it the same way #LoadNewGRFFile does.
+ * This does not use the Fio slots, so it can run on any thread.
+ */
+void GRFFileIndex::Build()
+{
+	FILE *f = FioFOpenFile(this->filename, "rb", this->subdir);
+	if (f == NULL) return;
+
+	GRFIndexReader reader(f);
+
+	/* Determine the container version, see GetGRFContainerVersion. */
+	size_t start = reader.GetPos();
+	if (reader.ReadWord() == 0) {
+		for (uint i = 0; i < lengthof(_grf_cont_v2_sig); i++) {
+			if (reader.ReadByte() != _grf_cont_v2_sig[i]) {
+				FioFCloseFile(f);
+				return;
+			}
+		}
+		this->container_version = 2;
+	} else {
+		reader.Seek(start);
+		this->container_version = 1;
+	}
+
+	bool ok = true;
+	if (this->container_version >= 2) {
+		/* The sprite section, see ReadGRFSpriteOffsets. */
+		size_t data_offset = reader.ReadDword();
+		size_t old_pos = reader.GetPos();
+		reader.Seek(old_pos + data_offset);
+
+		uint32 id, prev_id = 0;
+		while ((id = reader.ReadDword()) != 0) {
+			if (id != prev_id) this->sprite_offsets[id] = reader.GetPos() - 4;
+			prev_id = id;
+			reader.Skip(reader.ReadDword());
+		}
+		reader.Seek(old_pos);
+
+		/* Compressed files are not loaded at all. */
+		ok = reader.ReadByte() == 0;
+	}
+
+	/* The first sprite tells the number of sprites. */
+	if (ok) {
+		uint32 num = this->container_version >= 2 ? reader.ReadDword() : reader.ReadWord();
+		ok = num == 4 && reader.ReadByte() == 0xFF;
+		if (ok) reader.ReadDword();
+	}
+
+	if (ok) {
+		uint32 num;
+		while ((num = (this->container_version >= 2 ? reader.ReadDword() : reader.ReadWord())) != 0) {
+			byte type = reader.ReadByte();
+			if (type == 0xFF || (this->container_version >= 2 && type == 0xFD)) {
+				/* Pseudo sprites and references to the sprite section. */
+				reader.Skip(num);
+				continue;
+			}
+
+			reader.Skip(7);
+			size_t data_pos = reader.GetPos();
+			reader.SkipSpriteData(type, num - 8);
+			this->real_sprite_ends[data_pos] = reader.GetPos();
+		}
+	}
+
+	/* Anything odd about the file is left to the normal loading. */
+	this->valid = ok && !reader.eof;
+	FioFCloseFile(f);
+}
+
+/**
+ * Skip the data of a real sprite in the current Fio file, if it is indexed.
+ * @param pos The position of the data of the sprite.
+ * @return True if the sprite was skipped, false if it has to be walked over.
+ */
+bool GRFFileIndex::SkipRealSprite(size_t pos) const
+{
+	std::map<size_t, size_t>::const_iterator it = this->real_sprite_ends.find(pos);
+	if (it == this->real_sprite_ends.end()) return false;
+
+	FioSkipBytes(it->second - pos);
+	return true;
+}
+
+/**
+ * Queue a file for indexing by #BuildGRFFileIndices.
+ * @param filename The file to index; the string must stay valid until the indices are cleared.
+ * @param subdir The sub directory to find the file in.
+ */
+void AddGRFFileToIndex(const char *filename, Subdirectory subdir)
+{
+	*_grf_file_indices.Append() = new GRFFileIndex(filename, subdir);
+}
+
+/**
+ * Build the indices of one part of the queued files.
+ * @param part The part to build.
+ * @param parts The number of parts.
+ * @param data Unused.
+ */
+static void BuildGRFFileIndicesPart(uint part, uint parts, void *data)
+{
+	for (uint i = part; i < _grf_file_indices.Length(); i += parts) {
+		_grf_file_indices[i]->Build();
+	}
+}
+
+/**
+ * Build the indices of all queued files, spread over as many threads as there are cores.
+ * When no threads can be started the files are indexed on the current thread.
+ */
+void BuildGRFFileIndices()
+{
+	uint num_threads = Clamp(GetCPUCoreCount(), 1U, min(MAX_GRF_INDEX_THREADS, max(_grf_file_indices.Length(), 1U)));
+	RunParallel(num_threads, &BuildGRFFileIndicesPart, NULL);
+}
+
+/**
+ * Get the index of a file.
+ * @param filename The file.
+ * @param subdir The sub directory the file is found in.
+ * @return The index, or \c NULL if the file is not (validly) indexed.
+ */
+const GRFFileIndex *GetGRFFileIndex(const char *filename, Subdirectory subdir)
+{
+	for (GRFFileIndex **it = _grf_file_indices.Begin(); it != _grf_file_indices.End(); it++) {
+		if ((*it)->filename == filename && (*it)->subdir == subdir) return (*it)->valid ? *it : NULL;
+	}
+	return NULL;
+}
+
+/** Free the indices of all files. */
+void ClearGRFFileIndices()
+{
+	_grf_file_indices.Clear();
+}
@@ -0,0 +1,47 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_index.h Index of the sprites in NewGRF files, built in parallel before loading them. */
+
+#ifndef NEWGRF_INDEX_H
+#define NEWGRF_INDEX_H
+
+#include "fileio_type.h"
+#include <map>
+
+/**
+ * Positions of the sprites in a NewGRF file. It is gathered with its own file
+ * handle instead of the Fio slots, so the files can be indexed on worker threads.
+ * The loading stages use it to skip over real sprites without walking their data.
+ */
+struct GRFFileIndex {
+	const char *filename;                  ///< The indexed file.
+	Subdirectory subdir;                   ///< The sub directory to find the file in.
+	bool valid;                            ///< Whether the file could be indexed completely; an invalid index must not be used.
+	byte container_version;                ///< Container version of the file.
+	std::map<uint32, size_t> sprite_offsets;    ///< Position of the first entry of each ID in the sprite section, like #ReadGRFSpriteOffsets.
+	std::map<size_t, size_t> real_sprite_ends;  ///< Position after the data of each real sprite in the data section, by the position of that data.
+
+	/**
+	 * Create an (empty) index for a file.
+	 * @param filename The file to index.
+	 * @param subdir The sub directory to find the file in.
+	 */
+	GRFFileIndex(const char *filename, Subdirectory subdir) : filename(filename), subdir(subdir), valid(false), container_version(0) {}
+
+	void Build();
+	bool SkipRealSprite(size_t pos) const;
+};
+
+void AddGRFFileToIndex(const char *filename, Subdirectory subdir);
+void BuildGRFFileIndices();
+const GRFFileIndex *GetGRFFileIndex(const char *filename, Subdirectory subdir);
+void ClearGRFFileIndices();
+
+#endif /* NEWGRF_INDEX_H */
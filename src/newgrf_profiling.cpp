@@ -0,0 +1,133 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_profiling.cpp Profiling of the resolving of NewGRF action 2 chains. */
+
+#include "stdafx.h"
+#include "newgrf.h"
+#include "newgrf_config.h"
+#include "newgrf_profiling.h"
+#include "newgrf_spritegroup.h"
+#include "console_func.h"
+#include "string_func.h"
+#include "core/endian_func.hpp"
+#include "core/smallvec_type.hpp"
+#include "core/sort_func.hpp"
+#include "debug.h"
+#include <map>
+
+bool _newgrf_profiling; ///< Whether the resolving of action 2 chains is being profiled.
+
+/** What is known about the resolves of one callback of one NewGRF. */
+struct NewGRFProfileEntry {
+	uint32 grfid;            ///< The NewGRF.
+	CallbackID callback;     ///< The callback, or #CBID_NO_CALLBACK for sprites.
+	uint calls;              ///< Number of times the chain was resolved.
+	uint max_depth;          ///< Deepest nesting of sprite groups that was resolved.
+	RealTimeTimer time;      ///< Time spent resolving the chain.
+
+	NewGRFProfileEntry() : grfid(0), callback(CBID_NO_CALLBACK), calls(0), max_depth(0) {}
+};
+
+/** The profile, per NewGRF and callback. */
+typedef std::map<uint64, NewGRFProfileEntry> NewGRFProfile;
+
+static NewGRFProfile _newgrf_profile;     ///< The profile of the running or last profiling session.
+static uint _newgrf_profile_depth;        ///< Nesting of the sprite group that is being resolved.
+static uint _newgrf_profile_max_depth;    ///< Deepest nesting during the resolve of the current chain.
+
+/** Forget the previous profile, and start profiling the resolving of action 2 chains. */
+void StartNewGRFProfiling()
+{
+	_newgrf_profile.clear();
+	_newgrf_profiling = true;
+}
+
+/** Stop profiling; the profile is kept until profiling is started again. */
+void StopNewGRFProfiling()
+{
+	_newgrf_profiling = false;
+}
+
+/**
+ * Resolve a sprite group, and add the time it took to the profile. Only the
+ * time of the outermost resolve is measured; nested resolves, for example of
+ * procedures, are part of it and only count towards the depth.
+ * @param group The group to resolve.
+ * @param object Information needed to resolve the group.
+ * @return The resolved group.
+ */
+/* static */ const SpriteGroup *SpriteGroup::ResolveProfiled(const SpriteGroup *group, ResolverObject *object)
+{
+	if (_newgrf_profile_depth > 0) {
+		_newgrf_profile_depth++;
+		_newgrf_profile_max_depth = max(_newgrf_profile_max_depth, _newgrf_profile_depth);
+		const SpriteGroup *result = group->Resolve(object);
+		_newgrf_profile_depth--;
+		return result;
+	}
+
+	uint32 grfid = object->grffile != NULL ? object->grffile->grfid : 0;
+	NewGRFProfileEntry &entry = _newgrf_profile[(uint64)grfid << 16 | object->callback];
+	entry.grfid = grfid;
+	entry.callback = object->callback;
+
+	_newgrf_profile_depth = 1;
+	_newgrf_profile_max_depth = 1;
+
+	entry.time.Start();
+	const SpriteGroup *result = group->Resolve(object);
+	entry.time.Stop();
+
+	_newgrf_profile_depth = 0;
+	entry.calls++;
+	entry.max_depth = max(entry.max_depth, _newgrf_profile_max_depth);
+	return result;
+}
+
+/** Sort profile entries by the time spent in them, the most expensive first. */
+static int CDECL NewGRFProfileEntrySorter(NewGRFProfileEntry * const *a, NewGRFProfileEntry * const *b)
+{
+	if ((*b)->time.acc == (*a)->time.acc) return 0;
+	return (*b)->time.acc > (*a)->time.acc ? 1 : -1;
+}
+
+/**
+ * Print the NewGRFs and callbacks that took the most time to the console.
+ * @param count The maximum number of entries to print.
+ */
+void PrintNewGRFProfile(uint count)
+{
+	SmallVector<NewGRFProfileEntry *, 64> entries;
+	RealTimeTimer total;
+	uint calls = 0;
+	for (NewGRFProfile::iterator it = _newgrf_profile.begin(); it != _newgrf_profile.end(); it++) {
+		*entries.Append() = &it->second;
+		total.acc += it->second.time.acc;
+		calls += it->second.calls;
+	}
+	QSortT(entries.Begin(), entries.Length(), &NewGRFProfileEntrySorter);
+
+	IConsolePrintF(CC_INFO, "NewGRF profile%s: %u resolves in " OTTD_PRINTF64 " us", _newgrf_profiling ? " (running)" : "", calls, total.GetMicroseconds());
+	for (uint i = 0; i < entries.Length() && i < count; i++) {
+		NewGRFProfileEntry *entry = entries[i];
+
+		char callback[16];
+		if (entry->callback == CBID_NO_CALLBACK) {
+			strecpy(callback, "sprites", lastof(callback));
+		} else {
+			seprintf(callback, lastof(callback), "cb %X", entry->callback);
+		}
+
+		const GRFConfig *c = GetGRFConfig(entry->grfid);
+		IConsolePrintF(CC_DEFAULT, "  %08X %-8s %8u calls, %8u us, %7.3f us/call, depth %2u  %s",
+				BSWAP32(entry->grfid), callback, entry->calls, (uint)entry->time.GetMicroseconds(), (double)entry->time.acc / 1000 / entry->calls,
+				entry->max_depth, c != NULL ? c->GetName() : "");
+	}
+}
@@ -0,0 +1,21 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_profiling.h Profiling of the resolving of NewGRF action 2 chains. */
+
+#ifndef NEWGRF_PROFILING_H
+#define NEWGRF_PROFILING_H
+
+extern bool _newgrf_profiling;
+
+void StartNewGRFProfiling();
+void StopNewGRFProfiling();
+void PrintNewGRFProfile(uint count);
+
+#endif /* NEWGRF_PROFILING_H */
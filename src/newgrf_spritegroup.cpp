@@ -13,6 +13,7 @@
 #include "debug.h"
 #include "newgrf_spritegroup.h"
 #include "core/pool_func.hpp"
+#include "core/sort_func.hpp"
 
 SpriteGroupPool _spritegroup_pool("SpriteGroup");
 INSTANTIATE_POOL_METHODS(SpriteGroup)
@@ -27,6 +28,7 @@ DeterministicSpriteGroup::~DeterministicSpriteGroup()
 {
 	free(this->adjusts);
 	free(this->ranges);
+	free(this->segments);
 }
 
 RandomizedSpriteGroup::~RandomizedSpriteGroup()
@@ -216,18 +218,126 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 }
 
 
-const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject *object) const
+/**
+ * Evaluate an adjustment for a variable of the given size, when its variable
+ * is the same for every resolve.
+ * U is the unsigned type and S is the signed type to use.
+ * @param adjust The adjustment to evaluate.
+ * @param[in,out] last_value The result of the previous adjustment; replaced by the result of this one.
+ * @return False when the adjustment does not only depend on constants, or has side effects.
+ */
+template <typename U, typename S>
+static bool FoldAdjustT(const DeterministicSpriteGroupAdjust *adjust, uint32 *last_value)
 {
-	uint32 last_value = 0;
-	uint32 value = 0;
-	uint i;
+	switch (adjust->variable) {
+		case 0x0B: // TTDPatch version
+		case 0x11: // current rail tool type
+		case 0x1A: // always -1
+		case 0x1B: // display options
+		case 0x1D: // TTD platform
+		case 0x21: // OpenTTD version
+		case 0x22: // difficulty level
+			break;
+
+		default: return false;
+	}
 
-	ScopeResolver *scope = object->GetScope(this->var_scope);
+	if (adjust->operation == DSGA_OP_STO || adjust->operation == DSGA_OP_STOP) return false;
+	/* Leave a division by zero for the moment the chain is actually resolved. */
+	if (adjust->type != DSGA_TYPE_NONE && (U)adjust->divmod_val == 0) return false;
 
-	for (i = 0; i < this->num_adjusts; i++) {
-		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+	uint32 value;
+	GetGlobalVariable(adjust->variable, &value, NULL);
+	*last_value = EvalAdjustT<U, S>(adjust, NULL, *last_value, value);
+	return true;
+}
+
+/** Sort bounds of ranges ascending. */
+static int CDECL RangeBoundSorter(const uint32 *a, const uint32 *b)
+{
+	return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+/**
+ * Prepare the group for resolving, once it is completely read. The leading
+ * adjustments that only depend on constants are evaluated once here, and
+ * the ranges, of which the first one that matches wins, are turned into
+ * sorted segments without overlap so a value can be looked up with a
+ * binary search instead of by trying every range.
+ */
+void DeterministicSpriteGroup::Compile()
+{
+	this->first_adjust = 0;
+	this->first_value = 0;
+	while (this->first_adjust < this->num_adjusts) {
+		const DeterministicSpriteGroupAdjust *adjust = &this->adjusts[this->first_adjust];
+		bool folded;
+		switch (this->size) {
+			case DSG_SIZE_BYTE:  folded = FoldAdjustT<uint8,  int8> (adjust, &this->first_value); break;
+			case DSG_SIZE_WORD:  folded = FoldAdjustT<uint16, int16>(adjust, &this->first_value); break;
+			case DSG_SIZE_DWORD: folded = FoldAdjustT<uint32, int32>(adjust, &this->first_value); break;
+			default: NOT_REACHED();
+		}
+		if (!folded) break;
+		this->first_adjust++;
+	}
+
+	free(this->segments);
+	this->segments = NULL;
+	this->num_segments = 0;
+	if (this->num_ranges == 0) return;
+
+	/* A segment starts at zero, and wherever a range starts or ends. */
+	SmallVector<uint32, 16> bounds;
+	*bounds.Append() = 0;
+	for (uint i = 0; i < this->num_ranges; i++) {
+		const DeterministicSpriteGroupRange *range = &this->ranges[i];
+		if (range->low > range->high) continue;
+		bounds.Include(range->low);
+		if (range->high != UINT32_MAX) bounds.Include(range->high + 1);
+	}
+	QSortT(bounds.Begin(), bounds.Length(), &RangeBoundSorter);
+
+	this->segments = MallocT<DeterministicSpriteGroupRange>(bounds.Length());
+	for (uint i = 0; i < bounds.Length(); i++) {
+		/* No range starts or ends within the segment, so its first value tells which range matches all of it. */
+		const SpriteGroup *group = this->default_group;
+		for (uint j = 0; j < this->num_ranges; j++) {
+			if (this->ranges[j].low <= bounds[i] && bounds[i] <= this->ranges[j].high) {
+				group = this->ranges[j].group;
+				break;
+			}
+		}
+
+		uint32 high = i + 1 < bounds.Length() ? bounds[i + 1] - 1 : UINT32_MAX;
+		if (this->num_segments > 0 && this->segments[this->num_segments - 1].group == group) {
+			this->segments[this->num_segments - 1].high = high;
+			continue;
+		}
+
+		DeterministicSpriteGroupRange *segment = &this->segments[this->num_segments++];
+		segment->group = group;
+		segment->low   = bounds[i];
+		segment->high  = high;
+	}
+}
+
+/**
+ * Evaluate the adjustments that were not evaluated by #Compile, for a variable of the given size.
+ * U is the unsigned type and S is the signed type to use.
+ * @param object The object to resolve for.
+ * @param scope The scope to get the variables from.
+ * @param[in,out] last_value The value of the adjustments evaluated by #Compile; replaced by the result of the last adjustment.
+ * @return False when a variable is not available.
+ */
+template <typename U, typename S>
+bool DeterministicSpriteGroup::EvalAdjusts(ResolverObject *object, ScopeResolver *scope, uint32 *last_value) const
+{
+	for (uint i = this->first_adjust; i < this->num_adjusts; i++) {
+		const DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
 
 		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
+		uint32 value;
 		bool available = true;
 		if (adjust->variable == 0x7E) {
 			const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object);
@@ -239,27 +349,63 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject *object) con
 
 			/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
 		} else if (adjust->variable == 0x7B) {
-			value = GetVariable(object, scope, adjust->parameter, last_value, &available);
+			value = GetVariable(object, scope, adjust->parameter, *last_value, &available);
 		} else {
 			value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
 		}
 
-		if (!available) {
-			/* Unsupported variable: skip further processing and return either
-			 * the group from the first range or the default group. */
-			return SpriteGroup::Resolve(this->num_ranges > 0 ? this->ranges[0].group : this->default_group, object);
-		}
+		if (!available) return false;
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
+		*last_value = EvalAdjustT<U, S>(adjust, scope, *last_value, value);
+	}
+
+	return true;
+}
+
+/**
+ * Get the group a value resolves to.
+ * @param value The result of the adjustments.
+ * @return The group of the first range the value is in, or the default group.
+ */
+const SpriteGroup *DeterministicSpriteGroup::GetGroupForValue(uint32 value) const
+{
+	assert(this->num_segments > 0);
+
+	/* Find the last segment that starts at or before the value. */
+	uint low = 0;
+	uint high = this->num_segments - 1;
+	while (low < high) {
+		uint mid = (low + high + 1) / 2;
+		if (this->segments[mid].low <= value) {
+			low = mid;
+		} else {
+			high = mid - 1;
 		}
-		last_value = value;
+	}
+	return this->segments[low].group;
+}
+
+const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject *object) const
+{
+	uint32 value = this->first_value;
+
+	ScopeResolver *scope = object->GetScope(this->var_scope);
+
+	bool available;
+	switch (this->size) {
+		case DSG_SIZE_BYTE:  available = this->EvalAdjusts<uint8,  int8> (object, scope, &value); break;
+		case DSG_SIZE_WORD:  available = this->EvalAdjusts<uint16, int16>(object, scope, &value); break;
+		case DSG_SIZE_DWORD: available = this->EvalAdjusts<uint32, int32>(object, scope, &value); break;
+		default: NOT_REACHED();
+	}
+
+	if (!available) {
+		/* Unsupported variable: skip further processing and return either
+		 * the group from the first range or the default group. */
+		return SpriteGroup::Resolve(this->num_ranges > 0 ? this->ranges[0].group : this->default_group, object);
 	}
 
-	object->last_value = last_value;
+	object->last_value = value;
 
 	if (this->num_ranges == 0) {
 		/* nvar == 0 is a special case -- we turn our value into a callback result */
@@ -269,13 +415,7 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject *object) con
 		return &nvarzero;
 	}
 
-	for (i = 0; i < this->num_ranges; i++) {
-		if (this->ranges[i].low <= value && value <= this->ranges[i].high) {
-			return SpriteGroup::Resolve(this->ranges[i].group, object);
-		}
-	}
-
-	return SpriteGroup::Resolve(this->default_group, object);
+	return SpriteGroup::Resolve(this->GetGroupForValue(value), object);
 }
 
 
@@ -20,6 +20,7 @@
 #include "newgrf_generic.h"
 #include "newgrf_storage.h"
 #include "newgrf_commons.h"
+#include "newgrf_profiling.h"
 
 /**
  * Gets the value of a so-called newgrf "register".
@@ -56,6 +57,7 @@ enum SpriteGroupType {
 };
 
 struct SpriteGroup;
+struct ScopeResolver;
 typedef uint32 SpriteGroupID;
 
 /* SPRITE_WIDTH is 24. ECS has roughly 30 sprite groups per real sprite.
@@ -91,8 +93,13 @@ public:
 	 */
 	static const SpriteGroup *Resolve(const SpriteGroup *group, ResolverObject *object)
 	{
-		return group == NULL ? NULL : group->Resolve(object);
+		if (group == NULL) return NULL;
+		if (_newgrf_profiling) return ResolveProfiled(group, object);
+		return group->Resolve(object);
 	}
+
+private:
+	static const SpriteGroup *ResolveProfiled(const SpriteGroup *group, ResolverObject *object);
 };
 
 
@@ -203,8 +210,21 @@ struct DeterministicSpriteGroup : SpriteGroup {
 	/* Dynamically allocated, this is the sole owner */
 	const SpriteGroup *default_group;
 
+	/* Filled by Compile(), once all of the above is known. */
+	uint first_adjust;                          ///< First adjust that has to be evaluated; the ones before it only depend on constants.
+	uint32 first_value;                         ///< The value after evaluating the adjusts before #first_adjust.
+	uint num_segments;                          ///< Number of segments in #segments.
+	DeterministicSpriteGroupRange *segments;    ///< Non-overlapping ranges, sorted by value, that cover all values and tell the group each value resolves to.
+
+	void Compile();
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject *object) const;
+
+private:
+	template <typename U, typename S>
+	bool EvalAdjusts(ResolverObject *object, ScopeResolver *scope, uint32 *last_value) const;
+	const SpriteGroup *GetGroupForValue(uint32 value) const;
 };
 
 enum RandomizedSpriteGroupCompareMode {
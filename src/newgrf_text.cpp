@@ -698,6 +698,50 @@ GRFText *DuplicateGRFText(GRFText *orig)
 	return newtext;
 }
 
+/**
+ * Write a GRFText list to a file, so it can be read back with #LoadGRFTextList.
+ * @param f The file to write to.
+ * @param list The list to write.
+ */
+void SaveGRFTextList(FILE *f, const GRFText *list)
+{
+	for (const GRFText *text = list; text != NULL; text = text->next) {
+		byte header[6] = { 1, text->langid, (byte)GB(text->len, 0, 8), (byte)GB(text->len, 8, 8), (byte)GB(text->len, 16, 8), (byte)GB(text->len, 24, 8) };
+		fwrite(header, 1, sizeof(header), f);
+		fwrite(text->text, 1, text->len, f);
+	}
+	fputc(0, f);
+}
+
+/**
+ * Read a GRFText list that was written by #SaveGRFTextList.
+ * @param f The file to read from.
+ * @param list [out] The read list; on failure it contains the texts read so far.
+ * @return False when the file did not contain a valid list.
+ */
+bool LoadGRFTextList(FILE *f, GRFText **list)
+{
+	*list = NULL;
+	for (;;) {
+		byte header[6];
+		if (fread(header, 1, 1, f) != 1) return false;
+		if (header[0] == 0) return true;
+		if (header[0] != 1 || fread(header + 1, 1, sizeof(header) - 1, f) != sizeof(header) - 1) return false;
+
+		size_t len = header[2] | (header[3] << 8) | (header[4] << 16) | ((uint32)header[5] << 24);
+		if (len > UINT16_MAX) return false;
+
+		char *buffer = MallocT<char>(len);
+		bool ok = fread(buffer, 1, len, f) == len;
+		if (ok) {
+			*list = GRFText::New(header[1], buffer, len);
+			list = &(*list)->next;
+		}
+		free(buffer);
+		if (!ok) return false;
+	}
+}
+
 /**
  * Add the new read string into our structure.
  */
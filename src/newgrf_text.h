@@ -28,6 +28,8 @@ void CleanUpStrings();
 void SetCurrentGrfLangID(byte language_id);
 char *TranslateTTDPatchCodes(uint32 grfid, uint8 language_id, bool allow_newlines, const char *str, int *olen = NULL, StringControlCode byte80 = SCC_NEWGRF_PRINT_WORD_STRING_ID);
 struct GRFText *DuplicateGRFText(struct GRFText *orig);
+void SaveGRFTextList(FILE *f, const struct GRFText *list);
+bool LoadGRFTextList(FILE *f, struct GRFText **list);
 void AddGRFTextToList(struct GRFText **list, struct GRFText *text_to_add);
 void AddGRFTextToList(struct GRFText **list, byte langid, uint32 grfid, bool allow_newlines, const char *text_to_add);
 void AddGRFTextToList(struct GRFText **list, const char *text_to_add);
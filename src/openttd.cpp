@@ -56,11 +56,13 @@
 #include "core/backup_type.hpp"
 #include "hotkeys.h"
 #include "newgrf.h"
+#include "newgrf_engine.h"
 #include "misc/getoptdata.h"
 #include "game/game.hpp"
 #include "game/game_config.hpp"
 #include "town.h"
 #include "subsidy_func.h"
+#include "performance_counters.h"
 
 
 #include <stdarg.h>
@@ -78,6 +80,8 @@ extern Company *DoStartupNewCompany(bool is_ai, CompanyID company = INVALID_COMP
 extern void ShowOSErrorBox(const char *buf, bool system);
 extern char *_config_file;
 
+PerformanceCounters _performance_counters; ///< The work done by the game loop.
+
 /**
  * Error handling for fatal user errors.
  * @param s the string to print.
@@ -1271,6 +1275,8 @@ static void CheckCaches()
 
 	/* Check whether the caches are still valid */
 	FOR_ALL_VEHICLES(v) {
+		/* Applying the pending age updates the cache, so do that before taking the copy. */
+		v->cargo.ApplyPendingAge();
 		byte buff[sizeof(VehicleCargoList)];
 		memcpy(buff, &v->cargo, sizeof(VehicleCargoList));
 		v->cargo.InvalidateCache();
@@ -1304,7 +1310,10 @@ void StateGameLoop()
 	}
 	if (HasModalProgress()) return;
 
+	_performance_counters.tick_time.Start();
+
 	ClearStorageChanges(false);
+	InvalidateVehicleCallbackCaches();
 
 	if (_game_mode == GM_EDITOR) {
 		RunTileLoop();
@@ -1345,6 +1354,9 @@ void StateGameLoop()
 		cur_company.Restore();
 	}
 
+	_performance_counters.tick_time.Stop();
+	_performance_counters.ticks++;
+
 	assert(IsLocalCompany());
 }
 
@@ -1405,7 +1417,8 @@ void GameLoop()
 		_switch_mode = SM_NONE;
 	}
 
-	IncreaseSpriteLRU();
+	ProcessSpritePrefetchQueue();
+	ProcessGlyphPrefetchQueue();
 	InteractiveRandom();
 
 	extern int _caret_timer;
@@ -11,6 +11,14 @@
 
 #include "stdafx.h"
 
+#if defined(WIN32)
+#	include <windows.h>
+#else
+#	include <time.h>
+#	include <sys/time.h>
+#	include <unistd.h>
+#endif
+
 #undef RDTSC_AVAILABLE
 
 /* rdtsc for MSC_VER, uses simple inline assembly, or _rdtsc
@@ -74,3 +82,30 @@ uint64 ottd_rdtsc()
 # endif
 uint64 ottd_rdtsc() {return 0;}
 #endif
+
+/* A real time clock, for measuring how long things take regardless of the
+ * speed of the CPU. Prefer a monotonic clock where there is one. */
+#if defined(WIN32)
+uint64 ottd_nanoseconds()
+{
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	/* Split the conversion so it does not overflow for large counts. */
+	return (uint64)(count.QuadPart / frequency.QuadPart) * 1000000000 + (uint64)(count.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+}
+#else
+uint64 ottd_nanoseconds()
+{
+#if defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) return (uint64)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+	/* Without a monotonic clock fall back to the time of day, with only microsecond precision. */
+	struct timeval tim;
+	gettimeofday(&tim, NULL);
+	return (uint64)tim.tv_sec * 1000000000 + (uint64)tim.tv_usec * 1000;
+}
+#endif
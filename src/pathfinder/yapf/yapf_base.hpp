@@ -14,6 +14,7 @@
 
 #include "../../debug.h"
 #include "../../settings_type.h"
+#include "yapf_recorder.h"
 
 extern int _total_pf_time_us;
 
@@ -154,6 +155,10 @@ public:
 
 		bDestFound &= (m_pBestDestNode != NULL);
 
+		_yapf_run_stats.nodes      += m_num_steps;
+		_yapf_run_stats.cost_calcs += m_stats_cost_calcs;
+		_yapf_run_stats.cache_hits += m_stats_cache_hits;
+
 #ifndef NO_DEBUG_MESSAGES
 		perf.Stop();
 		if (_debug_yapf_level >= 2) {
@@ -545,7 +545,9 @@ Track YapfTrainChooseTrack(const Train *v, TileIndex tile, DiagDirection enterdi
 	}
 
 	Trackdir td_ret = pfnChooseRailTrack(v, tile, enterdir, tracks, path_found, reserve_track, target);
-	return (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : FindFirstTrack(tracks);
+	Track track = (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : FindFirstTrack(tracks);
+	if (YapfIsRecording()) YapfRecordQuery(YQT_TRAIN, v, tile, enterdir, tracks, reserve_track, path_found, track);
+	return track;
 }
 
 bool YapfTrainCheckReverse(const Train *v)
@@ -0,0 +1,304 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file yapf_recorder.cpp Recording and replaying of YAPF track choice queries. */
+
+#include "../../stdafx.h"
+#include "../../train.h"
+#include "../../roadveh.h"
+#include "../../ship.h"
+#include "../../fileio_func.h"
+#include "../../console_func.h"
+#include "../../console_type.h"
+#include "../../debug.h"
+#include "yapf.h"
+#include "yapf_recorder.h"
+
+YapfRunStats _yapf_run_stats;   ///< Counters of all YAPF runs since the game started.
+FILE *_yapf_record_file = NULL; ///< File the track choice queries are recorded to, or \c NULL when not recording.
+
+/** Magic bytes at the start of every recording. */
+static const char YAPF_RECORD_MAGIC[4] = { 'Y', 'P', 'F', 'R' };
+/** Version of the recording format; bump when #YapfQueryRecord changes. */
+static const byte YAPF_RECORD_VERSION = 1;
+
+/** Flags of a recorded query. */
+enum YapfQueryRecordFlags {
+	YQRF_RESERVE    = 0, ///< The train query was allowed to reserve its path.
+	YQRF_PATH_FOUND = 1, ///< The pathfinder found a path to the destination.
+};
+
+/** One recorded track choice query with the answer the pathfinder gave. */
+struct YapfQueryRecord {
+	byte type;           ///< The #YapfQueryType.
+	byte enterdir;       ///< Diagonal direction the vehicle enters the tile from.
+	byte flags;          ///< Bitmask of #YapfQueryRecordFlags.
+	VehicleID vehicle;   ///< The vehicle that asked for a path.
+	TileIndex tile;      ///< The tile the vehicle is about to enter.
+	uint32 choices;      ///< Available tracks or trackdirs on that tile.
+	uint32 result;       ///< The chosen track or trackdir.
+};
+
+/** Number of bytes a #YapfQueryRecord occupies in the file. */
+static const size_t YAPF_RECORD_SIZE = 3 + 4 * 4;
+
+/**
+ * Write a record to a recording file.
+ * @param f The file to write to.
+ * @param rec The record to write.
+ */
+static void WriteQueryRecord(FILE *f, const YapfQueryRecord &rec)
+{
+	byte buf[YAPF_RECORD_SIZE];
+	byte *p = buf;
+	*p++ = rec.type;
+	*p++ = rec.enterdir;
+	*p++ = rec.flags;
+	const uint32 fields[] = { rec.vehicle, rec.tile, rec.choices, rec.result };
+	for (uint i = 0; i < lengthof(fields); i++) {
+		for (uint j = 0; j < 4; j++) *p++ = GB(fields[i], j * 8, 8);
+	}
+	fwrite(buf, 1, sizeof(buf), f);
+}
+
+/**
+ * Read a record from a recording file.
+ * @param f The file to read from.
+ * @param rec [out] The record that was read.
+ * @return True when a complete record could be read.
+ */
+static bool ReadQueryRecord(FILE *f, YapfQueryRecord &rec)
+{
+	byte buf[YAPF_RECORD_SIZE];
+	if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) return false;
+
+	const byte *p = buf;
+	rec.type     = *p++;
+	rec.enterdir = *p++;
+	rec.flags    = *p++;
+	uint32 fields[4];
+	for (uint i = 0; i < lengthof(fields); i++) {
+		fields[i] = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32)p[3] << 24);
+		p += 4;
+	}
+	rec.vehicle = fields[0];
+	rec.tile    = fields[1];
+	rec.choices = fields[2];
+	rec.result  = fields[3];
+	return true;
+}
+
+/**
+ * Open a recording file and write the header.
+ * @param filename The file to (over)write.
+ * @return The opened file, or \c NULL on failure.
+ */
+static FILE *OpenRecordingForWriting(const char *filename)
+{
+	FILE *f = FioFOpenFile(filename, "wb", BASE_DIR);
+	if (f == NULL) return NULL;
+
+	fwrite(YAPF_RECORD_MAGIC, 1, sizeof(YAPF_RECORD_MAGIC), f);
+	fputc(YAPF_RECORD_VERSION, f);
+	return f;
+}
+
+/**
+ * Start recording all track choice queries to a file.
+ * A previously running recording is stopped first.
+ * @param filename The file to record to.
+ * @return True when the recording could be started.
+ */
+bool YapfStartRecording(const char *filename)
+{
+	YapfStopRecording();
+	_yapf_record_file = OpenRecordingForWriting(filename);
+	return _yapf_record_file != NULL;
+}
+
+/** Stop recording track choice queries, if a recording is running. */
+void YapfStopRecording()
+{
+	if (_yapf_record_file == NULL) return;
+
+	FioFCloseFile(_yapf_record_file);
+	_yapf_record_file = NULL;
+}
+
+/**
+ * Write a track choice query and its answer to the running recording.
+ * @param type       The kind of query.
+ * @param v          The vehicle that asked for a path.
+ * @param tile       The tile the vehicle is about to enter.
+ * @param enterdir   Diagonal direction the vehicle enters the tile from.
+ * @param choices    Available tracks or trackdirs on the tile.
+ * @param reserve    Whether the query was allowed to reserve a path.
+ * @param path_found Whether the pathfinder found a path.
+ * @param result     The chosen track or trackdir.
+ */
+void YapfRecordQuery(YapfQueryType type, const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint32 choices, bool reserve, bool path_found, uint result)
+{
+	assert(YapfIsRecording());
+
+	YapfQueryRecord rec;
+	rec.type     = type;
+	rec.enterdir = enterdir;
+	rec.flags    = (reserve ? 1 << YQRF_RESERVE : 0) | (path_found ? 1 << YQRF_PATH_FOUND : 0);
+	rec.vehicle  = v->index;
+	rec.tile     = tile;
+	rec.choices  = choices;
+	rec.result   = result;
+	WriteQueryRecord(_yapf_record_file, rec);
+}
+
+/** Totals of the replayed queries of one #YapfQueryType. */
+struct YapfReplayTotals {
+	uint queries;             ///< Number of queries replayed.
+	YapfRunStats stats;       ///< Pathfinder work done by the replayed queries.
+	RealTimeTimer timer;      ///< Time spent in the replayed queries.
+
+	YapfReplayTotals() : queries(0)
+	{
+		MemSetT(&this->stats, 0);
+	}
+};
+
+/**
+ * Run a recorded query again on the current game state.
+ * Paths are never reserved, not even for train queries that reserved one when they
+ * were recorded, so replaying does not change the game state.
+ * @param rec The query to replay.
+ * @param result [out] The answer of the pathfinder.
+ * @param path_found [out] Whether the pathfinder found a path.
+ * @return False when the vehicle of the query does not exist (anymore).
+ */
+static bool ReplayQuery(const YapfQueryRecord &rec, uint &result, bool &path_found)
+{
+	DiagDirection enterdir = (DiagDirection)rec.enterdir;
+	switch (rec.type) {
+		case YQT_TRAIN: {
+			const Train *v = Train::GetIfValid(rec.vehicle);
+			if (v == NULL) return false;
+			result = YapfTrainChooseTrack(v, rec.tile, enterdir, (TrackBits)rec.choices, path_found, false, NULL);
+			return true;
+		}
+
+		case YQT_ROAD: {
+			const RoadVehicle *v = RoadVehicle::GetIfValid(rec.vehicle);
+			if (v == NULL) return false;
+			result = YapfRoadVehicleChooseTrack(v, rec.tile, enterdir, (TrackdirBits)rec.choices, path_found);
+			return true;
+		}
+
+		case YQT_SHIP: {
+			const Ship *v = Ship::GetIfValid(rec.vehicle);
+			if (v == NULL) return false;
+			result = YapfShipChooseTrack(v, rec.tile, enterdir, (TrackBits)rec.choices, path_found);
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Replay a recording of track choice queries on the current game state and print
+ * the number of nodes visited, the cache hits and the time spent per query type.
+ * Only the state of the savegame the recording was started from is restored, not
+ * the state of the tick each query was made in: vehicles are where the savegame
+ * has them and paths may be reserved differently. The answers can thus differ from
+ * the recorded ones, but they are the same for every build replaying the same
+ * recording on the same savegame.
+ * @param filename The recording to replay.
+ * @param output   If not \c NULL, write the answers of the replayed queries to this
+ *                 file so they can be compared with the results of another build.
+ * @return False when the recording could not be read.
+ */
+bool YapfReplayQueries(const char *filename, const char *output)
+{
+	static const char * const type_names[] = { "train", "road", "ship" };
+	assert_compile(lengthof(type_names) == YQT_END);
+
+	if (YapfIsRecording()) {
+		IConsolePrintF(CC_ERROR, "Stop recording pathfinder queries before replaying a recording.");
+		return false;
+	}
+
+	FILE *f = FioFOpenFile(filename, "rb", BASE_DIR);
+	if (f == NULL) {
+		IConsolePrintF(CC_ERROR, "Cannot open pathfinder recording '%s'.", filename);
+		return false;
+	}
+
+	char magic[sizeof(YAPF_RECORD_MAGIC)];
+	if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, YAPF_RECORD_MAGIC, sizeof(magic)) != 0 || fgetc(f) != YAPF_RECORD_VERSION) {
+		IConsolePrintF(CC_ERROR, "'%s' is not a pathfinder recording of this version.", filename);
+		FioFCloseFile(f);
+		return false;
+	}
+
+	FILE *out = NULL;
+	if (output != NULL) {
+		out = OpenRecordingForWriting(output);
+		if (out == NULL) IConsolePrintF(CC_WARNING, "Cannot write replay results to '%s'.", output);
+	}
+
+	YapfReplayTotals totals[YQT_END];
+	uint skipped = 0;
+
+	YapfQueryRecord rec;
+	while (ReadQueryRecord(f, rec)) {
+		if (rec.type >= YQT_END) {
+			skipped++;
+			continue;
+		}
+
+		YapfReplayTotals &t = totals[rec.type];
+		YapfRunStats before = _yapf_run_stats;
+		uint result;
+		bool path_found;
+
+		t.timer.Start();
+		bool valid = ReplayQuery(rec, result, path_found);
+		t.timer.Stop();
+
+		if (!valid) {
+			skipped++;
+			continue;
+		}
+
+		t.queries++;
+		t.stats.nodes      += _yapf_run_stats.nodes      - before.nodes;
+		t.stats.cost_calcs += _yapf_run_stats.cost_calcs - before.cost_calcs;
+		t.stats.cache_hits += _yapf_run_stats.cache_hits - before.cache_hits;
+
+		if (out != NULL) {
+			rec.result = result;
+			SB(rec.flags, YQRF_PATH_FOUND, 1, path_found ? 1 : 0);
+			WriteQueryRecord(out, rec);
+		}
+	}
+
+	FioFCloseFile(f);
+	if (out != NULL) FioFCloseFile(out);
+
+	IConsolePrintF(CC_INFO, "Replayed pathfinder recording '%s' (%u queries skipped):", filename, skipped);
+	for (uint i = 0; i < YQT_END; i++) {
+		YapfReplayTotals &t = totals[i];
+		if (t.queries == 0) continue;
+
+		uint64 segments = t.stats.cost_calcs + t.stats.cache_hits;
+		IConsolePrintF(CC_DEFAULT, "  %-5s: %6u queries, " OTTD_PRINTF64 " nodes, " OTTD_PRINTF64 " segments (%.1f%% cached), %u us (%.1f us/query)",
+				type_names[i], t.queries, t.stats.nodes, segments,
+				segments == 0 ? 0.0 : t.stats.cache_hits * 100.0 / segments,
+				(uint)t.timer.GetMicroseconds(), t.timer.acc / 1000.0 / t.queries);
+	}
+	return true;
+}
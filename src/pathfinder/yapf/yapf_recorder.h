@@ -0,0 +1,51 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file yapf_recorder.h Recording and replaying of YAPF track choice queries. */
+
+#ifndef YAPF_RECORDER_H
+#define YAPF_RECORDER_H
+
+#include "../../direction_type.h"
+#include "../../tile_type.h"
+#include "../../vehicle_type.h"
+
+/** Kind of pathfinder query stored in a recording. */
+enum YapfQueryType {
+	YQT_TRAIN, ///< YapfTrainChooseTrack
+	YQT_ROAD,  ///< YapfRoadVehicleChooseTrack
+	YQT_SHIP,  ///< YapfShipChooseTrack
+	YQT_END,   ///< End marker
+};
+
+/** Counters accumulated over all YAPF runs, used to measure the work done by a query. */
+struct YapfRunStats {
+	uint64 nodes;      ///< Number of A* rounds, i.e. nodes taken from the open list.
+	uint64 cost_calcs; ///< Number of segment costs that had to be calculated.
+	uint64 cache_hits; ///< Number of segment costs reused from the segment cost cache.
+};
+
+extern YapfRunStats _yapf_run_stats;
+extern FILE *_yapf_record_file;
+
+/**
+ * Is there a recording of pathfinder queries running?
+ * @return True when every track choice query is being written to a file.
+ */
+static inline bool YapfIsRecording()
+{
+	return _yapf_record_file != NULL;
+}
+
+bool YapfStartRecording(const char *filename);
+void YapfStopRecording();
+void YapfRecordQuery(YapfQueryType type, const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint32 choices, bool reserve, bool path_found, uint result);
+bool YapfReplayQueries(const char *filename, const char *output);
+
+#endif /* YAPF_RECORDER_H */
@@ -490,7 +490,9 @@ Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDi
 	}
 
 	Trackdir td_ret = pfnChooseRoadTrack(v, tile, enterdir, path_found);
-	return (td_ret != INVALID_TRACKDIR) ? td_ret : (Trackdir)FindFirstBit2x64(trackdirs);
+	if (td_ret == INVALID_TRACKDIR) td_ret = (Trackdir)FindFirstBit2x64(trackdirs);
+	if (YapfIsRecording()) YapfRecordQuery(YQT_ROAD, v, tile, enterdir, trackdirs, false, path_found, td_ret);
+	return td_ret;
 }
 
 FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_distance)
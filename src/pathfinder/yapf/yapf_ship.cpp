@@ -231,7 +231,9 @@ Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir,
 	}
 
 	Trackdir td_ret = pfnChooseShipTrack(v, tile, enterdir, tracks, path_found);
-	return (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : INVALID_TRACK;
+	Track track = (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : INVALID_TRACK;
+	if (YapfIsRecording()) YapfRecordQuery(YQT_SHIP, v, tile, enterdir, tracks, false, path_found, track);
+	return track;
 }
 
 bool YapfShipCheckReverse(const Ship *v)
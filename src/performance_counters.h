@@ -0,0 +1,42 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file performance_counters.h Counters of the work done by the game loop. */
+
+#ifndef PERFORMANCE_COUNTERS_H
+#define PERFORMANCE_COUNTERS_H
+
+#include "debug.h"
+
+/**
+ * Counters of the work done by the game loop since the game was started.
+ * They only ever increase, so anyone interested in them keeps the values
+ * from the last time it looked, and uses the difference.
+ */
+struct PerformanceCounters {
+	uint64 ticks;                ///< Number of game ticks that were run.
+	RealTimeTimer tick_time;     ///< Time spent running game ticks.
+	uint64 pathfinder_calls;     ///< Number of times a vehicle asked a pathfinder for a track.
+	uint64 cargo_delivered;      ///< Amount of cargo that was delivered to its destination.
+
+	PerformanceCounters() : ticks(0), pathfinder_calls(0), cargo_delivered(0) {}
+
+	/**
+	 * Get the time spent running game ticks.
+	 * @return The time in microseconds.
+	 */
+	inline uint64 GetTickTime() const
+	{
+		return this->tick_time.GetMicroseconds();
+	}
+};
+
+extern PerformanceCounters _performance_counters;
+
+#endif /* PERFORMANCE_COUNTERS_H */
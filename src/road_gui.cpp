@@ -944,8 +944,6 @@ struct BuildRoadStationWindow : public PickerWindowBase {
 		this->LowerWidget(_settings_client.gui.station_show_coverage + WID_BROS_LT_OFF);
 
 		this->FinishInitNested(desc, TRANSPORT_ROAD);
-
-		this->window_class = (rs == ROADSTOP_BUS) ? WC_BUS_STATION : WC_TRUCK_STATION;
 	}
 
 	virtual ~BuildRoadStationWindow()
@@ -1063,16 +1061,23 @@ static const NWidgetPart _nested_rv_station_picker_widgets[] = {
 	EndContainer(),
 };
 
-static const WindowDesc _rv_station_picker_desc(
+static const WindowDesc _bus_station_picker_desc(
 	WDP_AUTO, 0, 0,
 	WC_BUS_STATION, WC_BUILD_TOOLBAR,
 	WDF_CONSTRUCTION,
 	_nested_rv_station_picker_widgets, lengthof(_nested_rv_station_picker_widgets)
 );
 
+static const WindowDesc _truck_station_picker_desc(
+	WDP_AUTO, 0, 0,
+	WC_TRUCK_STATION, WC_BUILD_TOOLBAR,
+	WDF_CONSTRUCTION,
+	_nested_rv_station_picker_widgets, lengthof(_nested_rv_station_picker_widgets)
+);
+
 static void ShowRVStationPicker(Window *parent, RoadStopType rs)
 {
-	new BuildRoadStationWindow(&_rv_station_picker_desc, parent, rs);
+	new BuildRoadStationWindow(rs == ROADSTOP_BUS ? &_bus_station_picker_desc : &_truck_station_picker_desc, parent, rs);
 }
 
 void InitializeRoadGui()
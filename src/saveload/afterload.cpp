@@ -52,6 +52,7 @@
 #include "../smallmap_gui.h"
 #include "../news_func.h"
 #include "../error.h"
+#include "../spatial_index.h"
 
 
 #include "saveload_internal.h"
@@ -254,6 +255,8 @@ static void InitializeWindowsAndCaches()
 
 	Station::RecomputeIndustriesNearForAll();
 	RebuildSubsidisedSourceAndDestinationCache();
+	/* Airport and depot locations may have been changed by the conversions. */
+	RebuildSpatialIndices();
 
 	/* Towns have a noise controlled number of airports system
 	 * So each airport's noise value must be added to the town->noise_reached value
@@ -513,6 +516,9 @@ bool AfterLoadGame()
 		_pause_mode &= ~PMB_PAUSED_NETWORK;
 	}
 
+	/* The savegame conversions below search for the closest town. */
+	RebuildSpatialIndices();
+
 	/* In very old versions, size of train stations was stored differently.
 	 * They had swapped width and height if station was built along the Y axis.
 	 * TTO and TTD used 3 bits for width/height, while OpenTTD used 4.
@@ -109,8 +109,11 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
-	CargoPacket *cp;
+	/* Vehicles age their cargo lazily; store the actual ages. */
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) v->cargo.ApplyPendingAge();
 
+	CargoPacket *cp;
 	FOR_ALL_CARGOPACKETS(cp) {
 		SlSetArrayIndex(cp->index);
 		SlObject(cp, GetCargoPacketDesc());
@@ -465,7 +465,7 @@ static void SaveLoad_PLYR_common(Company *c, CompanyProperties *cprops)
 	}
 }
 
-static void SaveLoad_PLYR(Company *c)
+void SaveLoad_PLYR(Company *c)
 {
 	SaveLoad_PLYR_common(c, c);
 }
@@ -63,6 +63,15 @@ static const SaveLoad _industry_desc[] = {
 	SLE_END()
 };
 
+/**
+ * Save a single industry.
+ * @param ind The industry to save.
+ */
+void RealSave_INDY(Industry *ind)
+{
+	SlObject(ind, _industry_desc);
+}
+
 static void Save_INDY()
 {
 	Industry *ind;
@@ -70,7 +79,7 @@ static void Save_INDY()
 	/* Write the industries */
 	FOR_ALL_INDUSTRIES(ind) {
 		SlSetArrayIndex(ind->index);
-		SlObject(ind, _industry_desc);
+		RealSave_INDY(ind);
 	}
 }
 
@@ -1293,11 +1293,13 @@ static void *IntToReference(size_t index, SLRefType rt)
 
 /**
  * Return the size in bytes of a list
- * @param list The std::list to find the size of
+ * @tparam PtrList The type of container, a std::list or std::deque of pointers.
+ * @param list The list to find the size of
  */
+template <class PtrList>
 static inline size_t SlCalcListLen(const void *list)
 {
-	const std::list<void *> *l = (const std::list<void *> *) list;
+	const PtrList *l = (const PtrList *) list;
 
 	int type_size = IsSavegameVersionBefore(69) ? 2 : 4;
 	/* Each entry is saved as type_size bytes, plus type_size bytes are used for the length
@@ -1308,26 +1310,27 @@ static inline size_t SlCalcListLen(const void *list)
 
 /**
  * Save/Load a list.
+ * @tparam PtrList The type of container, a std::list or std::deque of pointers.
  * @param list The list being manipulated
  * @param conv SLRefType type of the list (Vehicle *, Station *, etc)
  */
+template <class PtrList>
 static void SlList(void *list, SLRefType conv)
 {
 	/* Automatically calculate the length? */
 	if (_sl.need_length != NL_NONE) {
-		SlSetLength(SlCalcListLen(list));
+		SlSetLength(SlCalcListLen<PtrList>(list));
 		/* Determine length only? */
 		if (_sl.need_length == NL_CALCLENGTH) return;
 	}
 
-	typedef std::list<void *> PtrList;
 	PtrList *l = (PtrList *)list;
 
 	switch (_sl.action) {
 		case SLA_SAVE: {
 			SlWriteUint32((uint32)l->size());
 
-			PtrList::iterator iter;
+			typename PtrList::iterator iter;
 			for (iter = l->begin(); iter != l->end(); ++iter) {
 				void *ptr = *iter;
 				SlWriteUint32((uint32)ReferenceToInt(ptr, conv));
@@ -1349,7 +1352,7 @@ static void SlList(void *list, SLRefType conv)
 			PtrList temp = *l;
 
 			l->clear();
-			PtrList::iterator iter;
+			typename PtrList::iterator iter;
 			for (iter = temp.begin(); iter != temp.end(); ++iter) {
 				void *ptr = IntToReference((size_t)*iter, conv);
 				l->push_back(ptr);
@@ -1415,6 +1418,7 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 		case SL_ARR:
 		case SL_STR:
 		case SL_LST:
+		case SL_DEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) break;
 
@@ -1423,7 +1427,8 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 				case SL_REF: return SlCalcRefLen();
 				case SL_ARR: return SlCalcArrayLen(sld->length, sld->conv);
 				case SL_STR: return SlCalcStringLen(GetVariableAddress(object, sld), sld->length, sld->conv);
-				case SL_LST: return SlCalcListLen(GetVariableAddress(object, sld));
+				case SL_LST: return SlCalcListLen<std::list<void *> >(GetVariableAddress(object, sld));
+				case SL_DEQUE: return SlCalcListLen<std::deque<void *> >(GetVariableAddress(object, sld));
 				default: NOT_REACHED();
 			}
 			break;
@@ -1445,6 +1450,7 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 		case SL_ARR:
 		case SL_STR:
 		case SL_LST:
+		case SL_DEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) return false;
 			if (SlSkipVariableOnLoad(sld)) return false;
@@ -1471,7 +1477,8 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 					break;
 				case SL_ARR: SlArray(ptr, sld->length, conv); break;
 				case SL_STR: SlString(ptr, sld->length, sld->conv); break;
-				case SL_LST: SlList(ptr, (SLRefType)conv); break;
+				case SL_LST: SlList<std::list<void *> >(ptr, (SLRefType)conv); break;
+				case SL_DEQUE: SlList<std::deque<void *> >(ptr, (SLRefType)conv); break;
 				default: NOT_REACHED();
 			}
 			break;
@@ -1562,6 +1569,50 @@ void SlAutolength(AutolengthProc *proc, void *arg)
 	if (offs != _sl.dumper->GetSize()) SlErrorCorrupt("Invalid chunk size");
 }
 
+/**
+ * Save a single object, like SlAutolength would save it into a chunk, into
+ * a buffer instead of the savegame. This can be done while the game is
+ * running, but not while the game is being saved.
+ * @param proc The callback procedure that saves the object.
+ * @param arg The object to save.
+ * @param buffer The buffer to save the object into.
+ * @param length Is set to the length of the saved object.
+ * @return The saved object, or \c NULL when the game is being saved.
+ */
+const byte *SlSaveToBuffer(AutolengthProc *proc, void *arg, ReusableBuffer<byte> *buffer, size_t *length)
+{
+	if (_sl.saveinprogress) return NULL;
+
+	SaveLoadParams backup = _sl;
+	uint16 version = _sl_version;
+	byte minor_version = _sl_minor_version;
+	_sl_version = SAVEGAME_VERSION;
+	_sl_minor_version = 0;
+
+	/* Calculate the length, so the buffer can be made large enough at once. */
+	_sl.action = SLA_SAVE;
+	_sl.need_length = NL_CALCLENGTH;
+	_sl.obj_len = 0;
+	proc(arg);
+	*length = _sl.obj_len;
+
+	/* Let the dumper write directly into the buffer; it will not have to allocate any block. */
+	MemoryDumper dumper;
+	dumper.buf = buffer->Allocate(max<size_t>(*length, 1));
+	dumper.bufe = dumper.buf + *length;
+	const byte *data = dumper.buf;
+
+	_sl.dumper = &dumper;
+	_sl.need_length = NL_NONE;
+	proc(arg);
+	assert(dumper.buf == dumper.bufe && dumper.blocks.Length() == 0);
+
+	_sl = backup;
+	_sl_version = version;
+	_sl_minor_version = minor_version;
+	return data;
+}
+
 /**
  * Load a chunk of data (eg vehicles, stations, etc.)
  * @param ch The chunkhandler that will be used for the operation
@@ -14,6 +14,7 @@
 
 #include "../fileio_type.h"
 #include "../strings_type.h"
+#include "../core/alloc_type.hpp"
 
 /** Save or load result codes. */
 enum SaveOrLoadResult {
@@ -188,6 +189,7 @@ enum SaveLoadTypes {
 	SL_ARR         =  2, ///< Save/load an array.
 	SL_STR         =  3, ///< Save/load a string.
 	SL_LST         =  4, ///< Save/load a list.
+	SL_DEQUE       =  5, ///< Save/load a deque.
 	/* non-normal save-load types */
 	SL_WRITEBYTE   =  8,
 	SL_VEH_INCLUDE =  9,
@@ -279,6 +281,16 @@ typedef SaveLoad SaveLoadGlobVarList;
  */
 #define SLE_CONDLST(base, variable, type, from, to) SLE_GENERAL(SL_LST, base, variable, type, 0, from, to)
 
+/**
+ * Storage of a deque in some savegame versions. It is stored the same way as a list.
+ * @param base     Name of the class or struct containing the deque.
+ * @param variable Name of the variable in the class or struct referenced by \a base.
+ * @param type     Storage of the data in memory and in the savegame.
+ * @param from     First savegame version that has the deque.
+ * @param to       Last savegame version that has the deque.
+ */
+#define SLE_CONDDEQUE(base, variable, type, from, to) SLE_GENERAL(SL_DEQUE, base, variable, type, 0, from, to)
+
 /**
  * Storage of a variable in every version of a savegame.
  * @param base     Name of the class or struct containing the variable.
@@ -526,6 +538,7 @@ void SlSetArrayIndex(uint index);
 int SlIterateArray();
 
 void SlAutolength(AutolengthProc *proc, void *arg);
+const byte *SlSaveToBuffer(AutolengthProc *proc, void *arg, ReusableBuffer<byte> *buffer, size_t *length);
 size_t SlGetFieldLength();
 void SlSetLength(size_t length);
 size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld);
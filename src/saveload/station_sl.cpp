@@ -258,7 +258,7 @@ const SaveLoad *GetGoodsDesc()
 		SLEG_CONDVAR(            _cargo_feeder_share, SLE_FILE_U32 | SLE_VAR_I64, 14, 64),
 		SLEG_CONDVAR(            _cargo_feeder_share, SLE_INT64,                  65, 67),
 		 SLE_CONDVAR(GoodsEntry, amount_fract,        SLE_UINT8,                 150, SL_MAX_VERSION),
-		 SLE_CONDLST(GoodsEntry, cargo.packets,       REF_CARGO_PACKET,           68, SL_MAX_VERSION),
+		 SLE_CONDDEQUE(GoodsEntry, cargo.packets,     REF_CARGO_PACKET,           68, SL_MAX_VERSION),
 
 		SLE_END()
 	};
@@ -401,7 +401,7 @@ const SaveLoad *GetBaseStationDescription()
 	return _base_station_desc;
 }
 
-static void RealSave_STNN(BaseStation *bst)
+void RealSave_STNN(BaseStation *bst)
 {
 	bool waypoint = (bst->facilities & FACIL_WAYPOINT) != 0;
 	SlObject(bst, waypoint ? _waypoint_desc : _station_desc);
@@ -238,7 +238,7 @@ const SaveLoad *GetTileMatrixDesc()
 	return _tilematrix_desc;
 }
 
-static void RealSave_Town(Town *t)
+void RealSave_Town(Town *t)
 {
 	SlObject(t, _town_desc);
 
@@ -48,6 +48,7 @@
 #include "error.h"
 #include "town.h"
 #include "video/video_driver.hpp"
+#include "sprite_disk_cache.h"
 #include "sound/sound_driver.hpp"
 #include "music/music_driver.hpp"
 #include "blitter/factory.hpp"
@@ -33,6 +33,8 @@
 #include "company_base.h"
 #include "tunnelbridge_map.h"
 #include "zoom_func.h"
+#include "spatial_index.h"
+#include "performance_counters.h"
 
 #include "table/strings.h"
 
@@ -118,30 +120,33 @@ SpriteID Ship::GetImage(Direction direction, EngineImageType image_type) const
 	return _ship_sprites[spritenum] + direction;
 }
 
+/** Filter for #FindClosestShipDepot accepting the ship depots of a company. */
+struct ShipDepotFilter {
+	Owner owner; ///< Owner of the ship looking for a depot.
+
+	bool operator()(DepotID index) const
+	{
+		TileIndex tile = Depot::Get(index)->xy;
+		return IsShipDepotTile(tile) && IsTileOwner(tile, this->owner);
+	}
+};
+
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
-	/* Find the closest depot */
-	const Depot *depot;
-	const Depot *best_depot = NULL;
 	/* If we don't have a maximum distance, i.e. distance = 0,
 	 * we want to find any depot so the best distance of no
 	 * depot must be more than any correct distance. On the
 	 * other hand if we have set a maximum distance, any depot
 	 * further away than max_distance can safely be ignored. */
-	uint best_dist = max_distance == 0 ? UINT_MAX : max_distance + 1;
-
-	FOR_ALL_DEPOTS(depot) {
-		TileIndex tile = depot->xy;
-		if (IsShipDepotTile(tile) && IsTileOwner(tile, v->owner)) {
-			uint dist = DistanceManhattan(tile, v->tile);
-			if (dist < best_dist) {
-				best_dist = dist;
-				best_depot = depot;
-			}
-		}
-	}
+	uint threshold = max_distance == 0 ? UINT_MAX : max_distance + 1;
 
-	return best_depot;
+	ShipDepotFilter filter;
+	filter.owner = v->owner;
+
+	/* Find the closest depot */
+	DepotID index;
+	if (!_depot_spatial_index.FindNearest(v->tile, SM_MANHATTAN, threshold, filter, index)) return NULL;
+	return Depot::Get(index);
 }
 
 static void CheckIfShipNeedsService(Vehicle *v)
@@ -422,6 +427,8 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 {
 	assert(IsValidDiagDirection(enterdir));
 
+	_performance_counters.pathfinder_calls++;
+
 	bool path_found = true;
 	Track track;
 	switch (_settings_game.pf.pathfinder_for_ships) {
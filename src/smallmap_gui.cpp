@@ -165,6 +165,92 @@ static bool _smallmap_industry_highlight_state;
 /** For connecting company ID to position in owner list (small map legend) */
 static uint _company_to_list_pos[MAX_COMPANIES];
 
+/**
+ * Colours of the areas of tiles shown by a single pixel of the smallmap in its
+ * current mode and zoom level, by the northern tile of the area. They are kept
+ * while the smallmap is open, so only the colours of areas with a tile that
+ * changed have to be determined again when the smallmap is redrawn.
+ */
+static uint32 *_smallmap_area_colours = NULL;
+/** Bitmap of the areas whose colour in #_smallmap_area_colours is up to date. */
+static uint8 *_smallmap_area_colours_valid = NULL;
+/** Number of tiles #_smallmap_area_colours has been allocated for. */
+static uint _smallmap_area_colours_size = 0;
+/** Zoom level, i.e. size of the areas, of the colours in #_smallmap_area_colours. */
+static int _smallmap_area_colours_zoom = 0;
+
+/** Free the area colours, when there is no smallmap to show them anymore. */
+static void FreeSmallMapAreaColours()
+{
+	free(_smallmap_area_colours);
+	free(_smallmap_area_colours_valid);
+	_smallmap_area_colours = NULL;
+	_smallmap_area_colours_valid = NULL;
+	_smallmap_area_colours_size = 0;
+}
+
+/** Forget the colours of all areas, e.g. because the mode or legend of the smallmap changed. */
+static void InvalidateSmallMapAreaColours()
+{
+	if (_smallmap_area_colours_valid != NULL) MemSetT(_smallmap_area_colours_valid, 0, CeilDiv(_smallmap_area_colours_size, 8));
+}
+
+/**
+ * Make sure there are area colours for the current map and zoom level.
+ * @param zoom Zoom level of the smallmap.
+ * @post All area colours are invalid when the map size or zoom level has changed.
+ */
+static void AllocateSmallMapAreaColours(int zoom)
+{
+	if (_smallmap_area_colours_size != MapSize()) {
+		free(_smallmap_area_colours);
+		free(_smallmap_area_colours_valid);
+		_smallmap_area_colours_size = MapSize();
+		_smallmap_area_colours = MallocT<uint32>(_smallmap_area_colours_size);
+		_smallmap_area_colours_valid = CallocT<uint8>(CeilDiv(_smallmap_area_colours_size, 8));
+	} else if (_smallmap_area_colours_zoom != zoom) {
+		InvalidateSmallMapAreaColours();
+	}
+	_smallmap_area_colours_zoom = zoom;
+}
+
+/**
+ * Forget the colours of all areas a tile is part of, because the tile has changed.
+ * @param tile The tile that changed.
+ * @return Whether the smallmap has colours of areas at all.
+ */
+static bool InvalidateSmallMapAreaColoursOfTile(TileIndex tile)
+{
+	if (tile >= _smallmap_area_colours_size) return false;
+
+	/* The areas of all alignments that contain the tile have their northern tile at most zoom - 1 tiles away. */
+	uint x = TileX(tile);
+	uint y = TileY(tile);
+	for (uint ay = y - min<uint>(y, _smallmap_area_colours_zoom - 1); ay <= y; ay++) {
+		for (uint ax = x - min<uint>(x, _smallmap_area_colours_zoom - 1); ax <= x; ax++) {
+			TileIndex area = TileXY(ax, ay);
+			ClrBit(_smallmap_area_colours_valid[area / 8], area % 8);
+		}
+	}
+	return true;
+}
+
+/**
+ * Get a summary of the town names shown in the smallmap, to notice that they changed.
+ * @return The summary of the positions, widths and names of the towns.
+ */
+static uint32 GetTownSignsSummary()
+{
+	uint32 summary = 2166136261U;
+	const Town *t;
+	FOR_ALL_TOWNS(t) {
+		summary = (summary ^ t->xy) * 16777619U;
+		summary = (summary ^ t->cache.sign.width_small) * 16777619U;
+		summary = (summary ^ (uint32)(size_t)t->name) * 16777619U;
+	}
+	return summary;
+}
+
 /**
  * Fills an array for the industries legends.
  */
@@ -194,6 +280,8 @@ void BuildIndustriesLegend()
 
 	/* Store number of enabled industries */
 	_smallmap_industry_count = j;
+
+	InvalidateSmallMapAreaColours();
 }
 
 static const LegendAndColour * const _legend_table[] = {
@@ -305,6 +393,7 @@ void BuildLandLegend()
 	for (LegendAndColour *lc = _legend_land_contours; lc->legend == STR_TINY_BLACK_HEIGHT; lc++) {
 		lc->colour = _heightmap_schemes[_settings_client.gui.smallmap_land_colour].height_colours[lc->height];
 	}
+	InvalidateSmallMapAreaColours();
 }
 
 /**
@@ -331,6 +420,8 @@ void BuildOwnerLegend()
 
 	/* Store maximum amount of owner legend entries. */
 	_smallmap_company_count = i;
+
+	InvalidateSmallMapAreaColours();
 }
 
 struct AndOr {
@@ -601,10 +692,17 @@ class SmallMapWindow : public Window {
 	int32 subscroll; ///< Number of pixels (0..3) between the right end of the base tile and the pixel at the top-left corner of the smallmap display.
 	int zoom;        ///< Zoom level. Bigger number means more zoom-out (further away).
 
-	static const uint FORCE_REFRESH_PERIOD = 0x1F; ///< map is redrawn after that many ticks
+	static const uint FORCE_REFRESH_PERIOD = 0x1F; ///< changed parts of the map are redrawn after that many ticks
 	static const uint BLINK_PERIOD         = 0x0F; ///< highlight blinking interval
 	uint8 refresh; ///< refresh counter, zeroed every FORCE_REFRESH_PERIOD ticks
 
+	bool *dirty_rows;   ///< For each row of pixels of the map, whether a tile shown in it changed since the last refresh.
+	bool *vehicle_rows; ///< For each row of pixels of the map, whether a vehicle was drawn in it since the last refresh.
+	uint num_rows;      ///< Number of rows in #dirty_rows and #vehicle_rows.
+	Point indicator_tl; ///< Top-left corner of the main viewport indicator at the last refresh.
+	Point indicator_br; ///< Bottom-right corner of the main viewport indicator at the last refresh.
+	uint32 town_signs;  ///< Summary of the town names shown at the last refresh, see #GetTownSignsSummary.
+
 	inline Point SmallmapRemapCoords(int x, int y) const
 	{
 		Point pt;
@@ -814,18 +912,26 @@ class SmallMapWindow : public Window {
 			if (dst < _screen.dst_ptr) continue;
 			if (dst >= dst_ptr_abs_end) continue;
 
-			/* Construct tilearea covered by (xc, yc, xc + this->zoom, yc + this->zoom) such that it is within min_xy limits. */
-			TileArea ta;
-			if (min_xy == 1 && (xc == 0 || yc == 0)) {
-				if (this->zoom == 1) continue; // The tile area is empty, don't draw anything.
-
-				ta = TileArea(TileXY(max(min_xy, xc), max(min_xy, yc)), this->zoom - (xc == 0), this->zoom - (yc == 0));
+			uint32 val;
+			TileIndex area = TileXY(xc, yc);
+			if (HasBit(_smallmap_area_colours_valid[area / 8], area % 8)) {
+				val = _smallmap_area_colours[area];
 			} else {
-				ta = TileArea(TileXY(xc, yc), this->zoom, this->zoom);
-			}
-			ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
+				/* Construct tilearea covered by (xc, yc, xc + this->zoom, yc + this->zoom) such that it is within min_xy limits. */
+				TileArea ta;
+				if (min_xy == 1 && (xc == 0 || yc == 0)) {
+					if (this->zoom == 1) continue; // The tile area is empty, don't draw anything.
 
-			uint32 val = this->GetTileColours(ta);
+					ta = TileArea(TileXY(max(min_xy, xc), max(min_xy, yc)), this->zoom - (xc == 0), this->zoom - (yc == 0));
+				} else {
+					ta = TileArea(TileXY(xc, yc), this->zoom, this->zoom);
+				}
+				ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
+
+				val = this->GetTileColours(ta);
+				_smallmap_area_colours[area] = val;
+				SetBit(_smallmap_area_colours_valid[area / 8], area % 8);
+			}
 			uint8 *val8 = (uint8 *)&val;
 			int idx = max(0, -start_pos);
 			for (int pos = max(0, start_pos); pos < end_pos; pos++) {
@@ -873,6 +979,9 @@ class SmallMapWindow : public Window {
 			/* And draw either one or two pixels depending on clipping */
 			blitter->SetPixel(dpi->dst_ptr, x, y, colour);
 			if (!skip) blitter->SetPixel(dpi->dst_ptr, x + 1, y, colour);
+
+			/* Remember to remove it again when it has moved. */
+			if ((uint)pt.y < this->num_rows) this->vehicle_rows[pt.y] = true;
 		}
 	}
 
@@ -926,20 +1035,31 @@ class SmallMapWindow : public Window {
 	}
 
 	/**
-	 * Adds map indicators to the smallmap.
+	 * Get the position of the main viewport indicator on the smallmap.
+	 * @param[out] tl Top-left corner of the indicator.
+	 * @param[out] br Bottom-right corner of the indicator.
 	 */
-	void DrawMapIndicators() const
+	void GetMapIndicator(Point *tl, Point *br) const
 	{
 		/* Find main viewport. */
 		const ViewPort *vp = FindWindowById(WC_MAIN_WINDOW, 0)->viewport;
 
 		Point tile = InverseRemapCoords(vp->virtual_left, vp->virtual_top);
-		Point tl = this->RemapTile(tile.x >> 4, tile.y >> 4);
-		tl.x -= this->subscroll;
+		*tl = this->RemapTile(tile.x >> 4, tile.y >> 4);
+		tl->x -= this->subscroll;
 
 		tile = InverseRemapCoords(vp->virtual_left + vp->virtual_width, vp->virtual_top + vp->virtual_height);
-		Point br = this->RemapTile(tile.x >> 4, tile.y >> 4);
-		br.x -= this->subscroll;
+		*br = this->RemapTile(tile.x >> 4, tile.y >> 4);
+		br->x -= this->subscroll;
+	}
+
+	/**
+	 * Adds map indicators to the smallmap.
+	 */
+	void DrawMapIndicators() const
+	{
+		Point tl, br;
+		this->GetMapIndicator(&tl, &br);
 
 		SmallMapWindow::DrawVertMapIndicator(tl.x, tl.y, br.y);
 		SmallMapWindow::DrawVertMapIndicator(br.x, tl.y, br.y);
@@ -970,6 +1090,8 @@ class SmallMapWindow : public Window {
 		/* Clear it */
 		GfxFillRect(dpi->left, dpi->top, dpi->left + dpi->width - 1, dpi->top + dpi->height - 1, PC_BLACK);
 
+		AllocateSmallMapAreaColours(this->zoom);
+
 		/* Which tile is displayed at (dpi->left, dpi->top)? */
 		int dx;
 		Point tile = this->PixelToTile(dpi->left, dpi->top, &dx);
@@ -1058,7 +1180,7 @@ class SmallMapWindow : public Window {
 public:
 	uint min_number_of_columns;    ///< Minimal number of columns in legends.
 
-	SmallMapWindow(const WindowDesc *desc, int window_number) : Window(), refresh(FORCE_REFRESH_PERIOD)
+	SmallMapWindow(const WindowDesc *desc, int window_number) : Window(), refresh(FORCE_REFRESH_PERIOD), dirty_rows(NULL), vehicle_rows(NULL), num_rows(0)
 	{
 		_smallmap_industry_highlight = INVALID_INDUSTRYTYPE;
 		this->InitNested(desc, window_number);
@@ -1075,6 +1197,13 @@ public:
 		this->SmallMapCenterOnCurrentPos();
 	}
 
+	~SmallMapWindow()
+	{
+		FreeSmallMapAreaColours();
+		free(this->dirty_rows);
+		free(this->vehicle_rows);
+	}
+
 	/**
 	 * Compute minimal required width of the legends.
 	 * @return Minimally needed width for displaying the smallmap legends in pixels.
@@ -1262,6 +1391,7 @@ public:
 		this->RaiseWidget(this->map_type + WID_SM_CONTOUR);
 		this->map_type = map_type;
 		this->LowerWidget(this->map_type + WID_SM_CONTOUR);
+		InvalidateSmallMapAreaColours();
 
 		this->SetupWidgetData();
 
@@ -1302,6 +1432,7 @@ public:
 			_smallmap_industry_highlight = new_highlight;
 			this->refresh = _smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD;
 			_smallmap_industry_highlight_state = true;
+			InvalidateSmallMapAreaColours();
 			this->SetDirty();
 		}
 	}
@@ -1424,6 +1555,7 @@ public:
 							}
 						}
 					}
+					InvalidateSmallMapAreaColours();
 					this->SetDirty();
 				}
 				break;
@@ -1438,6 +1570,7 @@ public:
 						_legend_land_owners[i].show_on_map = true;
 					}
 				}
+				InvalidateSmallMapAreaColours();
 				this->SetDirty();
 				break;
 
@@ -1451,12 +1584,14 @@ public:
 						_legend_land_owners[i].show_on_map = false;
 					}
 				}
+				InvalidateSmallMapAreaColours();
 				this->SetDirty();
 				break;
 
 			case WID_SM_SHOW_HEIGHT: // Enable/disable showing of heightmap.
 				_smallmap_show_heightmap = !_smallmap_show_heightmap;
 				this->SetWidgetLoweredState(WID_SM_SHOW_HEIGHT, _smallmap_show_heightmap);
+				InvalidateSmallMapAreaColours();
 				this->SetDirty();
 				break;
 		}
@@ -1485,6 +1620,7 @@ public:
 				for (int i = 0; i != _smallmap_industry_count; i++) {
 					_legend_from_industries[i].show_on_map = HasBit(_displayed_industries, _legend_from_industries[i].type);
 				}
+				InvalidateSmallMapAreaColours();
 				break;
 			}
 
@@ -1521,8 +1657,84 @@ public:
 
 		_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
 
-		this->refresh = _smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD;
-		this->SetDirty();
+		if (_smallmap_industry_highlight != INVALID_INDUSTRYTYPE) {
+			/* Blinking changes the colours of the highlighted industries. */
+			InvalidateSmallMapAreaColours();
+			this->refresh = BLINK_PERIOD;
+			this->SetDirty();
+			return;
+		}
+
+		this->refresh = FORCE_REFRESH_PERIOD;
+		this->RefreshMap();
+	}
+
+	/**
+	 * Redraw the parts of the map that may have changed since the last refresh: the rows
+	 * with tiles that changed, and the rows with vehicles now or at the last refresh.
+	 * Everything is redrawn when the main viewport indicator or the town names changed.
+	 */
+	void RefreshMap()
+	{
+		const NWidgetBase *wid = this->GetWidget<NWidgetBase>(WID_SM_MAP);
+		Point tl, br;
+		this->GetMapIndicator(&tl, &br);
+		uint32 town_signs = this->show_towns ? GetTownSignsSummary() : 0;
+
+		if (this->num_rows != wid->current_y || tl.x != this->indicator_tl.x || tl.y != this->indicator_tl.y ||
+				br.x != this->indicator_br.x || br.y != this->indicator_br.y || town_signs != this->town_signs) {
+			this->num_rows = wid->current_y;
+			this->dirty_rows = ReallocT(this->dirty_rows, this->num_rows);
+			this->vehicle_rows = ReallocT(this->vehicle_rows, this->num_rows);
+			MemSetT(this->dirty_rows, 0, this->num_rows);
+			MemSetT(this->vehicle_rows, 0, this->num_rows);
+			this->indicator_tl = tl;
+			this->indicator_br = br;
+			this->town_signs = town_signs;
+			this->SetDirty();
+			return;
+		}
+
+		if (this->map_type == SMT_CONTOUR || this->map_type == SMT_VEHICLES) {
+			const Vehicle *v;
+			FOR_ALL_VEHICLES(v) {
+				if (v->type == VEH_EFFECT) continue;
+				if (v->vehstatus & (VS_HIDDEN | VS_UNCLICKABLE)) continue;
+
+				Point pt = this->RemapTile(v->x_pos / TILE_SIZE, v->y_pos / TILE_SIZE);
+				if ((uint)pt.y < this->num_rows) this->dirty_rows[pt.y] = true;
+			}
+		}
+
+		/* The map is drawn from one pixel below the top of its widget. */
+		int left = this->left + wid->pos_x;
+		int top = this->top + wid->pos_y + 1;
+		for (uint y = 0; y < this->num_rows;) {
+			if (!this->dirty_rows[y] && !this->vehicle_rows[y]) {
+				y++;
+				continue;
+			}
+
+			uint first = y;
+			for (; y < this->num_rows && (this->dirty_rows[y] || this->vehicle_rows[y]); y++) {
+				this->dirty_rows[y] = false;
+				this->vehicle_rows[y] = false;
+			}
+			SetDirtyBlocks(left, top + first, left + wid->current_x, top + y);
+		}
+	}
+
+	/**
+	 * Redraw the rows of the map showing a tile at the next refresh, because the tile has changed.
+	 * @param tile The tile that changed.
+	 */
+	void MarkTileRowsDirty(TileIndex tile)
+	{
+		Point pt = this->RemapTile(TileX(tile), TileY(tile));
+		/* Also the rows next to it; the drawing may round the area of the tile differently. */
+		for (int y = pt.y - 1; y <= pt.y + 1; y++) {
+			if ((uint)y < this->num_rows) this->dirty_rows[y] = true;
+		}
 	}
 
 	/**
@@ -1589,6 +1801,19 @@ public:
 SmallMapWindow::SmallMapType SmallMapWindow::map_type = SMT_CONTOUR;
 bool SmallMapWindow::show_towns = true;
 
+/**
+ * Forget the colour of a tile in the smallmap, and redraw the rows showing
+ * it at the next refresh, because the tile has changed.
+ * @param tile The tile that changed.
+ */
+void InvalidateSmallMapTile(TileIndex tile)
+{
+	if (!InvalidateSmallMapAreaColoursOfTile(tile)) return;
+
+	SmallMapWindow *w = dynamic_cast<SmallMapWindow *>(FindWindowById(WC_SMALLMAP, 0));
+	if (w != NULL) w->MarkTileRowsDirty(tile);
+}
+
 /**
  * Custom container class for displaying smallmap with a vertically resizing legend panel.
  * The legend panel has a smallest height that depends on its width. Standard containers cannot handle this case.
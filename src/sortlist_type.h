@@ -50,15 +50,17 @@ template <typename T, typename F = const char*>
 class GUIList : public SmallVector<T, 32> {
 public:
 	typedef int CDECL SortFunction(const T*, const T*); ///< Signature of sort function.
+	typedef void CDECL SortKeyFunction(const T*, uint); ///< Signature of function preparing the sort keys of all items.
 	typedef bool CDECL FilterFunction(const T*, F);     ///< Signature of filter function.
 
 protected:
-	SortFunction * const *sort_func_list;     ///< the sort criteria functions
-	FilterFunction * const *filter_func_list; ///< the filter criteria functions
-	SortListFlags flags;                      ///< used to control sorting/resorting/etc.
-	uint8 sort_type;                          ///< what criteria to sort on
-	uint8 filter_type;                        ///< what criteria to filter on
-	uint16 resort_timer;                      ///< resort list after a given amount of ticks if set
+	SortFunction * const *sort_func_list;        ///< the sort criteria functions
+	SortKeyFunction * const *sort_key_func_list; ///< the functions preparing the sort keys of the sort criteria, if any
+	FilterFunction * const *filter_func_list;    ///< the filter criteria functions
+	SortListFlags flags;                         ///< used to control sorting/resorting/etc.
+	uint8 sort_type;                             ///< what criteria to sort on
+	uint8 filter_type;                           ///< what criteria to filter on
+	uint16 resort_timer;                         ///< resort list after a given amount of ticks if set
 
 	/**
 	 * Check if the list is sortable
@@ -82,6 +84,7 @@ protected:
 public:
 	GUIList() :
 		sort_func_list(NULL),
+		sort_key_func_list(NULL),
 		filter_func_list(NULL),
 		flags(VL_FIRST_SORT),
 		sort_type(0),
@@ -250,10 +253,13 @@ public:
 	 *  use gsort.
 	 *
 	 * @param compare The function to compare two list items
+	 * @param prepare The function to determine the sort keys of all list items
+	 *                before sorting, so \a compare does not have to determine
+	 *                them for every comparison; may be \c NULL
 	 * @return true if the list sequence has been altered
 	 *
 	 */
-	bool Sort(SortFunction *compare)
+	bool Sort(SortFunction *compare, SortKeyFunction *prepare = NULL)
 	{
 		/* Do not sort if the resort bit is not set */
 		if (!(this->flags & VL_RESORT)) return false;
@@ -265,6 +271,8 @@ public:
 		/* Do not sort when the list is not sortable */
 		if (!this->IsSortable()) return false;
 
+		if (prepare != NULL) prepare(this->data, this->items);
+
 		const bool desc = (this->flags & VL_DESC) != 0;
 
 		if (this->flags & VL_FIRST_SORT) {
@@ -282,14 +290,17 @@ public:
 	 * Hand the array of sort function pointers to the sort list
 	 *
 	 * @param n_funcs The pointer to the first sort func
+	 * @param n_key_funcs The pointer to the first function preparing the sort
+	 *                    keys, or \c NULL when no sort func needs them
 	 */
-	void SetSortFuncs(SortFunction * const *n_funcs)
+	void SetSortFuncs(SortFunction * const *n_funcs, SortKeyFunction * const *n_key_funcs = NULL)
 	{
 		this->sort_func_list = n_funcs;
+		this->sort_key_func_list = n_key_funcs;
 	}
 
 	/**
-	 * Overload of #Sort(SortFunction *compare)
+	 * Overload of #Sort(SortFunction *compare, SortKeyFunction *prepare)
 	 * Overloaded to reduce external code
 	 *
 	 * @return true if the list sequence has been altered
@@ -297,7 +308,7 @@ public:
 	bool Sort()
 	{
 		assert(this->sort_func_list != NULL);
-		return this->Sort(this->sort_func_list[this->sort_type]);
+		return this->Sort(this->sort_func_list[this->sort_type], this->sort_key_func_list != NULL ? this->sort_key_func_list[this->sort_type] : NULL);
 	}
 
 	/**
@@ -401,4 +412,51 @@ public:
 	}
 };
 
+/**
+ * Sort keys of the items of a #GUIList that are strings, e.g. their names.
+ * They are determined once before sorting, so comparing two items only
+ * has to look them up. They are stored by the index of the item in its pool.
+ */
+class GUIListStrings {
+	SmallVector<uint, 32> offsets;  ///< Offset of the string of each index in #buffer.
+	SmallVector<char, 1024> buffer; ///< The strings, each terminated by a '\0'.
+
+public:
+	/** Forget all strings. */
+	void Clear()
+	{
+		this->offsets.Clear();
+		this->buffer.Clear();
+	}
+
+	/**
+	 * Set the string of an item.
+	 * @param index The index of the item.
+	 * @param str The string.
+	 */
+	void Set(uint index, const char *str)
+	{
+		if (index >= this->offsets.Length()) {
+			uint old_length = this->offsets.Length();
+			this->offsets.Append(index + 1 - old_length);
+			MemSetT(this->offsets.Get(old_length), 0, index + 1 - old_length);
+		}
+		*this->offsets.Get(index) = this->buffer.Length();
+
+		size_t length = strlen(str) + 1;
+		MemCpyT(this->buffer.Append((uint)length), str, length);
+	}
+
+	/**
+	 * Get the string of an item.
+	 * @param index The index of the item.
+	 * @pre The string of the item has been set.
+	 * @return The string.
+	 */
+	const char *Get(uint index) const
+	{
+		return this->buffer.Begin() + *this->offsets.Get(index);
+	}
+};
+
 #endif /* SORTLIST_TYPE_H */
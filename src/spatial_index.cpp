@@ -0,0 +1,53 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file spatial_index.cpp Grid indices over the locations of towns, airports, depots and stations. */
+
+#include "stdafx.h"
+#include "town.h"
+#include "station_base.h"
+#include "depot_base.h"
+#include "spatial_index.h"
+
+SpatialIndex<TownID>    _town_spatial_index;    ///< Index of all towns by their #Town::xy.
+SpatialIndex<StationID> _airport_spatial_index; ///< Index of all stations with an airport by their airport tile.
+SpatialIndex<DepotID>   _depot_spatial_index;   ///< Index of all depots by their #Depot::xy.
+SpatialAreaIndex<StationID> _station_rect_index; ///< Index of all stations by their #BaseStation::rect.
+
+/** Remove everything from the spatial indices and resize them to the current map. */
+void ResetSpatialIndices()
+{
+	_town_spatial_index.Reset();
+	_airport_spatial_index.Reset();
+	_depot_spatial_index.Reset();
+	_station_rect_index.Reset();
+}
+
+/** Rebuild the spatial indices from the pools, e.g. after loading a game. */
+void RebuildSpatialIndices()
+{
+	ResetSpatialIndices();
+
+	const Town *t;
+	FOR_ALL_TOWNS(t) {
+		if (t->xy < MapSize()) _town_spatial_index.Add(t->index, t->xy);
+	}
+
+	Station *st;
+	FOR_ALL_STATIONS(st) {
+		if ((st->facilities & FACIL_AIRPORT) && st->airport.tile < MapSize()) _airport_spatial_index.Add(st->index, st->airport.tile);
+		st->indexed_rect.MakeEmpty();
+		st->UpdateRectIndex();
+	}
+
+	const Depot *d;
+	FOR_ALL_DEPOTS(d) {
+		if (d->xy < MapSize()) _depot_spatial_index.Add(d->index, d->xy);
+	}
+}
@@ -0,0 +1,462 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file spatial_index.h Grid indices over the locations of towns, airports, depots and stations. */
+
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "core/smallvec_type.hpp"
+#include "core/geometry_type.hpp"
+#include "map_func.h"
+#include "town_type.h"
+#include "station_type.h"
+#include "depot_type.h"
+
+/** Distance metric used for spatial index queries. */
+enum SpatialMetric {
+	SM_MANHATTAN, ///< #DistanceManhattan
+	SM_SQUARE,    ///< #DistanceSquare
+};
+
+/** Filter that accepts every item of a spatial index. */
+struct SpatialAcceptAll {
+	inline bool operator()(uint id) const { return true; }
+};
+
+/**
+ * Index of items (towns, stations, depots, ...) by their location on the map.
+ * The map is split in square cells of #CELL_SIZE tiles, each holding the items
+ * located inside it. Queries search the cells in rings around the requested
+ * tile and stop as soon as no closer item can be found in the remaining cells.
+ *
+ * All queries give the same answer as a linear scan over the pool: of items
+ * with an equal distance the one with the lowest index wins.
+ *
+ * @tparam Tid Type of the index of the items.
+ */
+template <typename Tid>
+class SpatialIndex {
+public:
+	/** An item in the index. */
+	struct Item {
+		TileIndex tile; ///< Location of the item.
+		Tid id;         ///< Index of the item.
+	};
+
+	typedef SmallVector<Item, 4> ItemList; ///< List of items.
+
+	static const uint CELL_BITS = 4;              ///< Logarithm of the cell size.
+	static const uint CELL_SIZE = 1 << CELL_BITS; ///< Number of tiles along each side of a cell.
+
+private:
+	ItemList *cells; ///< Items in each of the cells, row by row.
+	uint size_x;     ///< Number of cells along the x axis.
+	uint size_y;     ///< Number of cells along the y axis.
+	uint count;      ///< Number of items in the index.
+
+	/**
+	 * Get the items in the cell containing a tile.
+	 * @param tile The tile.
+	 * @return The items of the cell.
+	 */
+	inline ItemList &GetCell(TileIndex tile) const
+	{
+		assert(this->cells != NULL && tile < MapSize());
+		return this->cells[(TileY(tile) >> CELL_BITS) * this->size_x + (TileX(tile) >> CELL_BITS)];
+	}
+
+	/**
+	 * Distance between two tiles in the given metric.
+	 * @param metric The metric.
+	 * @param t0 The first tile.
+	 * @param t1 The second tile.
+	 * @return The distance.
+	 */
+	static inline uint Distance(SpatialMetric metric, TileIndex t0, TileIndex t1)
+	{
+		return metric == SM_MANHATTAN ? DistanceManhattan(t0, t1) : DistanceSquare(t0, t1);
+	}
+
+	/**
+	 * Lower bound of the distance to any tile in the cells at a given ring.
+	 * @param metric The metric.
+	 * @param ring Distance in cells (L-Infinity-Norm) from the cell of the searched tile.
+	 * @return Lowest possible distance in the given metric.
+	 */
+	static inline uint MinRingDistance(SpatialMetric metric, uint ring)
+	{
+		if (ring == 0) return 0;
+		uint d = (ring - 1) * CELL_SIZE + 1;
+		return metric == SM_MANHATTAN ? d : d * d;
+	}
+
+	/**
+	 * Call a function for every cell at a given ring around a cell.
+	 * @param cx Cell x coordinate of the centre.
+	 * @param cy Cell y coordinate of the centre.
+	 * @param ring Distance in cells (L-Infinity-Norm) from the centre.
+	 * @param proc The function to call with each list of items.
+	 */
+	template <class Tproc>
+	void ForRing(uint cx, uint cy, uint ring, Tproc &proc) const
+	{
+		int x0 = (int)cx - (int)ring;
+		int x1 = (int)cx + (int)ring;
+		int y0 = (int)cy - (int)ring;
+		int y1 = (int)cy + (int)ring;
+		for (int y = max(y0, 0); y <= min(y1, (int)this->size_y - 1); y++) {
+			/* On the top and bottom row visit every cell, otherwise only both ends. */
+			int step = (y == y0 || y == y1 || ring == 0) ? 1 : x1 - x0;
+			for (int x = x0; x <= x1; x += step) {
+				if (x < 0 || x >= (int)this->size_x) continue;
+				proc(this->cells[y * this->size_x + x]);
+			}
+		}
+	}
+
+	/** Ring visitor for #FindNearest. */
+	template <class Tfilter>
+	struct NearestFinder {
+		SpatialMetric metric; ///< Metric to use.
+		TileIndex tile;       ///< The tile to search from.
+		uint best_dist;       ///< Distance of the best item so far, or the threshold.
+		Tid best;             ///< The best item so far.
+		bool found;           ///< Whether any item was found.
+		const Tfilter &filter; ///< Filter of acceptable items.
+
+		NearestFinder(SpatialMetric metric, TileIndex tile, uint threshold, const Tfilter &filter) :
+				metric(metric), tile(tile), best_dist(threshold), best(0), found(false), filter(filter) {}
+
+		void operator()(const ItemList &list)
+		{
+			for (const Item *it = list.Begin(); it != list.End(); it++) {
+				uint dist = Distance(this->metric, this->tile, it->tile);
+				if (dist > this->best_dist) continue;
+				/* The threshold is exclusive; on equal distance the lowest index wins. */
+				if (dist == this->best_dist && (!this->found || it->id > this->best)) continue;
+				if (!this->filter(it->id)) continue;
+				this->best_dist = dist;
+				this->best = it->id;
+				this->found = true;
+			}
+		}
+	};
+
+	/** Ring visitor for #FindNearestN. */
+	template <class Tfilter>
+	struct NearestNFinder {
+		SpatialMetric metric;   ///< Metric to use.
+		TileIndex tile;         ///< The tile to search from.
+		uint n;                 ///< Number of items to find.
+		uint threshold;         ///< Exclusive maximum distance.
+		const Tfilter &filter;  ///< Filter of acceptable items.
+		SmallVector<Tid, 16> &result;   ///< Best items so far, closest first.
+		SmallVector<uint, 16> dists;    ///< Distances of the items in #result.
+
+		NearestNFinder(SpatialMetric metric, TileIndex tile, uint n, uint threshold, const Tfilter &filter, SmallVector<Tid, 16> &result) :
+				metric(metric), tile(tile), n(n), threshold(threshold), filter(filter), result(result) {}
+
+		/** Exclusive bound for new items: the threshold, or the worst item when the result is complete. */
+		inline uint Bound() const
+		{
+			return this->dists.Length() < this->n ? this->threshold : this->dists[this->dists.Length() - 1];
+		}
+
+		void operator()(const ItemList &list)
+		{
+			for (const Item *it = list.Begin(); it != list.End(); it++) {
+				uint dist = Distance(this->metric, this->tile, it->tile);
+				if (dist >= this->threshold) continue;
+
+				/* Find the insert position keeping (distance, id) sorted. */
+				uint pos = this->dists.Length();
+				while (pos > 0 && (this->dists[pos - 1] > dist || (this->dists[pos - 1] == dist && this->result[pos - 1] > it->id))) pos--;
+				if (pos >= this->n) continue;
+				if (!this->filter(it->id)) continue;
+
+				if (this->dists.Length() < this->n) {
+					*this->dists.Append() = 0;
+					*this->result.Append() = 0;
+				}
+				for (uint i = this->dists.Length() - 1; i > pos; i--) {
+					this->dists[i] = this->dists[i - 1];
+					this->result[i] = this->result[i - 1];
+				}
+				this->dists[pos] = dist;
+				this->result[pos] = it->id;
+			}
+		}
+	};
+
+public:
+	SpatialIndex() : cells(NULL), size_x(0), size_y(0), count(0) {}
+
+	~SpatialIndex()
+	{
+		delete[] this->cells;
+	}
+
+	/** Remove all items and resize the index to the current map. */
+	void Reset()
+	{
+		delete[] this->cells;
+		this->size_x = max(1U, MapSizeX() >> CELL_BITS);
+		this->size_y = max(1U, MapSizeY() >> CELL_BITS);
+		this->cells = new ItemList[this->size_x * this->size_y];
+		this->count = 0;
+	}
+
+	/**
+	 * Get the number of items in the index.
+	 * @return The number of items.
+	 */
+	inline uint Count() const
+	{
+		return this->count;
+	}
+
+	/**
+	 * Add an item to the index.
+	 * @param id The index of the item.
+	 * @param tile The location of the item.
+	 */
+	void Add(Tid id, TileIndex tile)
+	{
+		Item *item = this->GetCell(tile).Append();
+		item->tile = tile;
+		item->id = id;
+		this->count++;
+	}
+
+	/**
+	 * Remove an item from the index, if it is in there.
+	 * @param id The index of the item.
+	 * @param tile The location the item was added with.
+	 */
+	void Remove(Tid id, TileIndex tile)
+	{
+		if (this->cells == NULL || tile >= MapSize()) return;
+
+		ItemList &list = this->GetCell(tile);
+		for (Item *it = list.Begin(); it != list.End(); it++) {
+			if (it->id == id && it->tile == tile) {
+				list.Erase(it);
+				this->count--;
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Find the item closest to a tile.
+	 * @param tile The tile to search from.
+	 * @param metric The distance metric.
+	 * @param threshold Only find items closer than this distance.
+	 * @param filter Functor telling whether an item is acceptable.
+	 * @param[out] result The closest acceptable item.
+	 * @return Whether an item was found.
+	 */
+	template <class Tfilter>
+	bool FindNearest(TileIndex tile, SpatialMetric metric, uint threshold, const Tfilter &filter, Tid &result) const
+	{
+		if (this->count == 0 || threshold == 0) return false;
+
+		uint cx = TileX(tile) >> CELL_BITS;
+		uint cy = TileY(tile) >> CELL_BITS;
+		uint max_ring = max(max(cx, this->size_x - 1 - cx), max(cy, this->size_y - 1 - cy));
+
+		NearestFinder<Tfilter> finder(metric, tile, threshold, filter);
+		for (uint ring = 0; ring <= max_ring; ring++) {
+			uint bound = MinRingDistance(metric, ring);
+			/* Items at the same distance can still win by having a lower index. */
+			if (finder.found ? bound > finder.best_dist : bound >= finder.best_dist) break;
+			this->ForRing(cx, cy, ring, finder);
+		}
+
+		if (finder.found) result = finder.best;
+		return finder.found;
+	}
+
+	/**
+	 * Find the items closest to a tile.
+	 * @param tile The tile to search from.
+	 * @param metric The distance metric.
+	 * @param n Maximum number of items to find.
+	 * @param threshold Only find items closer than this distance.
+	 * @param filter Functor telling whether an item is acceptable.
+	 * @param[out] result The closest acceptable items, closest first.
+	 */
+	template <class Tfilter>
+	void FindNearestN(TileIndex tile, SpatialMetric metric, uint n, uint threshold, const Tfilter &filter, SmallVector<Tid, 16> &result) const
+	{
+		result.Clear();
+		if (this->count == 0 || n == 0) return;
+
+		uint cx = TileX(tile) >> CELL_BITS;
+		uint cy = TileY(tile) >> CELL_BITS;
+		uint max_ring = max(max(cx, this->size_x - 1 - cx), max(cy, this->size_y - 1 - cy));
+
+		NearestNFinder<Tfilter> finder(metric, tile, n, threshold, filter, result);
+		for (uint ring = 0; ring <= max_ring; ring++) {
+			uint bound = MinRingDistance(metric, ring);
+			if (result.Length() < n ? bound >= threshold : bound > finder.Bound()) break;
+			this->ForRing(cx, cy, ring, finder);
+		}
+	}
+
+	/**
+	 * Find all items within a Manhattan distance of a tile.
+	 * @param tile The tile to search from.
+	 * @param radius The maximum Manhattan distance (inclusive).
+	 * @param[out] result The items within the radius, sorted by index.
+	 */
+	void FindInRadius(TileIndex tile, uint radius, SmallVector<Tid, 16> &result) const
+	{
+		result.Clear();
+		if (this->count == 0) return;
+
+		uint x0 = (uint)max<int>(0, (int)TileX(tile) - (int)radius) >> CELL_BITS;
+		uint y0 = (uint)max<int>(0, (int)TileY(tile) - (int)radius) >> CELL_BITS;
+		uint x1 = min(TileX(tile) + radius, MapMaxX()) >> CELL_BITS;
+		uint y1 = min(TileY(tile) + radius, MapMaxY()) >> CELL_BITS;
+
+		for (uint y = y0; y <= min(y1, this->size_y - 1); y++) {
+			for (uint x = x0; x <= min(x1, this->size_x - 1); x++) {
+				const ItemList &list = this->cells[y * this->size_x + x];
+				for (const Item *it = list.Begin(); it != list.End(); it++) {
+					if (DistanceManhattan(tile, it->tile) > radius) continue;
+
+					/* Insertion sort; the number of results is small. */
+					*result.Append() = it->id;
+					Tid *pos = result.End() - 1;
+					while (pos != result.Begin() && *(pos - 1) > it->id) {
+						*pos = *(pos - 1);
+						pos--;
+					}
+					*pos = it->id;
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Index of items covering a rectangular area of the map, e.g. the tiles of a
+ * station. The map is split in square blocks of #BLOCK_SIZE tiles, each holding
+ * the items whose area overlaps it.
+ *
+ * @tparam Tid Type of the index of the items.
+ */
+template <typename Tid>
+class SpatialAreaIndex {
+public:
+	static const uint BLOCK_BITS = 4;               ///< Logarithm of the block size.
+	static const uint BLOCK_SIZE = 1 << BLOCK_BITS; ///< Number of tiles along each side of a block.
+
+private:
+	SmallVector<Tid, 2> *blocks; ///< Items overlapping each of the blocks, row by row.
+	uint size_x;                 ///< Number of blocks along the x axis.
+	uint size_y;                 ///< Number of blocks along the y axis.
+
+	/**
+	 * Convert an area in tiles to the range of blocks it overlaps.
+	 * @param area The area in tiles, all coordinates inclusive.
+	 * @return The blocks, all coordinates inclusive.
+	 */
+	inline Rect ToBlocks(const Rect &area) const
+	{
+		Rect blocks;
+		blocks.left   = min<int>(max(area.left, 0),   this->size_x * BLOCK_SIZE - 1) >> BLOCK_BITS;
+		blocks.top    = min<int>(max(area.top, 0),    this->size_y * BLOCK_SIZE - 1) >> BLOCK_BITS;
+		blocks.right  = min<int>(max(area.right, 0),  this->size_x * BLOCK_SIZE - 1) >> BLOCK_BITS;
+		blocks.bottom = min<int>(max(area.bottom, 0), this->size_y * BLOCK_SIZE - 1) >> BLOCK_BITS;
+		return blocks;
+	}
+
+public:
+	SpatialAreaIndex() : blocks(NULL), size_x(0), size_y(0) {}
+
+	~SpatialAreaIndex()
+	{
+		delete[] this->blocks;
+	}
+
+	/** Remove all items and resize the index to the current map. */
+	void Reset()
+	{
+		delete[] this->blocks;
+		this->size_x = max(1U, MapSizeX() >> BLOCK_BITS);
+		this->size_y = max(1U, MapSizeY() >> BLOCK_BITS);
+		this->blocks = new SmallVector<Tid, 2>[this->size_x * this->size_y];
+	}
+
+	/**
+	 * Add an item to the index.
+	 * @param id The index of the item.
+	 * @param area The area covered by the item, all coordinates inclusive.
+	 */
+	void Add(Tid id, const Rect &area)
+	{
+		Rect b = this->ToBlocks(area);
+		for (int y = b.top; y <= b.bottom; y++) {
+			for (int x = b.left; x <= b.right; x++) {
+				*this->blocks[y * this->size_x + x].Append() = id;
+			}
+		}
+	}
+
+	/**
+	 * Remove an item from the index.
+	 * @param id The index of the item.
+	 * @param area The area the item was added with.
+	 */
+	void Remove(Tid id, const Rect &area)
+	{
+		if (this->blocks == NULL) return;
+
+		Rect b = this->ToBlocks(area);
+		for (int y = b.top; y <= b.bottom; y++) {
+			for (int x = b.left; x <= b.right; x++) {
+				SmallVector<Tid, 2> &list = this->blocks[y * this->size_x + x];
+				Tid *it = list.Find(id);
+				if (it != list.End()) list.Erase(it);
+			}
+		}
+	}
+
+	/**
+	 * Find the items whose area may overlap the given area.
+	 * @param area The area to search, all coordinates inclusive.
+	 * @param[out] result The items, each listed once, in no particular order.
+	 */
+	void FindOverlapping(const Rect &area, SmallVector<Tid, 16> &result) const
+	{
+		result.Clear();
+		if (this->blocks == NULL) return;
+
+		Rect b = this->ToBlocks(area);
+		for (int y = b.top; y <= b.bottom; y++) {
+			for (int x = b.left; x <= b.right; x++) {
+				const SmallVector<Tid, 2> &list = this->blocks[y * this->size_x + x];
+				for (const Tid *it = list.Begin(); it != list.End(); it++) result.Include(*it);
+			}
+		}
+	}
+};
+
+extern SpatialIndex<TownID>    _town_spatial_index;
+extern SpatialIndex<StationID> _airport_spatial_index;
+extern SpatialIndex<DepotID>   _depot_spatial_index;
+extern SpatialAreaIndex<StationID> _station_rect_index;
+
+void ResetSpatialIndices();
+void RebuildSpatialIndices();
+
+#endif /* SPATIAL_INDEX_H */
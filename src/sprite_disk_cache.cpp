@@ -0,0 +1,311 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file sprite_disk_cache.cpp On-disk cache of sprites, as encoded by the blitter. */
+
+#include "stdafx.h"
+#include "debug.h"
+#include "fileio_func.h"
+#include "fios.h"
+#include "gfx_func.h"
+#include "settings_type.h"
+#include "string_func.h"
+#include "rev.h"
+#include "blitter/factory.hpp"
+#include "core/smallvec_type.hpp"
+#include "sprite_disk_cache.h"
+
+bool _sprite_disk_cache; ///< Whether sprites are cached on disk after they are encoded by the blitter.
+
+/** Magic bytes at the start of a sprite disk cache file. */
+static const char SPRITE_DISK_CACHE_MAGIC[4] = { 'O', 'S', 'D', 'C' };
+/** Version of the sprite disk cache format; bump when the layout of the file changes. */
+static const byte SPRITE_DISK_CACHE_VERSION = 1;
+/** Size of the header of a sprite in the cache: its position in the GRF, its type and its size. */
+static const size_t SPRITE_DISK_CACHE_ENTRY_HEADER = 4 + 1 + 4;
+
+/**
+ * The cached sprites of the GRF in one file slot. Each GRF gets a cache file per
+ * blitter and zoom levels; sprites are appended to it as they are encoded.
+ */
+struct SpriteDiskCacheFile {
+	/** Location of a sprite in the cache file. */
+	struct Entry {
+		size_t pos;  ///< Position of the encoded sprite in the file.
+		uint32 size; ///< Size of the encoded sprite.
+	};
+
+	uint8 md5sum[16];     ///< MD5 sum of the GRF in the slot; all zero when it is not known.
+	bool opened;          ///< Whether opening the cache file has been tried for the current blitter and zoom levels.
+	const char *blitter;  ///< Name of the blitter the cache file is for.
+	ZoomLevel zoom_min;   ///< Minimum zoom level the cache file is for.
+	ZoomLevel zoom_max;   ///< Maximum zoom level the cache file is for.
+	FILE *f;              ///< The cache file, or \c NULL when sprites of this slot are not cached.
+	const byte *map;      ///< Memory mapping of the file as it was when it was opened, or \c NULL.
+	size_t map_size;      ///< Size of #map.
+	size_t end;           ///< End of the last complete sprite in the file; new sprites are written here.
+	std::map<uint64, Entry> entries; ///< The cached sprites by #GetSpriteDiskCacheKey.
+};
+
+static SpriteDiskCacheFile _sprite_disk_cache_files[MAX_FILE_SLOTS]; ///< The cache files of all file slots.
+
+/**
+ * Get the key of a sprite within a cache file.
+ * @param file_pos Position of the sprite in its GRF.
+ * @param type The type the sprite is encoded as.
+ * @return The key.
+ */
+static inline uint64 GetSpriteDiskCacheKey(size_t file_pos, SpriteType type)
+{
+	return ((uint64)file_pos << 8) | type;
+}
+
+/**
+ * Read data from a cache file, from its memory mapping when possible.
+ * @param c The cache file.
+ * @param pos Position of the data.
+ * @param buffer Destination of the data.
+ * @param len Number of bytes to read.
+ * @return True when all data could be read.
+ */
+static bool ReadSpriteDiskCacheData(const SpriteDiskCacheFile &c, size_t pos, void *buffer, size_t len)
+{
+	if (c.map != NULL && pos + len <= c.map_size) {
+		memcpy(buffer, c.map + pos, len);
+		return true;
+	}
+	return fseek(c.f, pos, SEEK_SET) == 0 && fread(buffer, 1, len, c.f) == len;
+}
+
+/**
+ * Close a cache file.
+ * @param c The cache file.
+ */
+static void CloseSpriteDiskCacheFile(SpriteDiskCacheFile &c)
+{
+	FioUnmapFile(c.map, c.map_size);
+	if (c.f != NULL) fclose(c.f);
+	c.f = NULL;
+	c.map = NULL;
+	c.map_size = 0;
+	c.entries.clear();
+	c.opened = false;
+}
+
+/** The header of a cache file, which identifies everything the encoded sprites depend on. */
+typedef SmallVector<byte, 128> SpriteDiskCacheHeader;
+
+/**
+ * Append data to the header of a cache file.
+ * @param header The header.
+ * @param data The data to append.
+ * @param len The length of the data.
+ */
+static void AppendToSpriteDiskCacheHeader(SpriteDiskCacheHeader &header, const void *data, size_t len)
+{
+	memcpy(header.Append((uint)len), data, len);
+}
+
+/**
+ * Get the header a cache file should have.
+ * @param header [out] The header.
+ * @param c The cache file.
+ * @param grf_size The size of the GRF.
+ * @param remap Whether the palette of the GRF is converted.
+ */
+static void GetSpriteDiskCacheHeader(SpriteDiskCacheHeader &header, const SpriteDiskCacheFile &c, uint64 grf_size, bool remap)
+{
+	AppendToSpriteDiskCacheHeader(header, SPRITE_DISK_CACHE_MAGIC, sizeof(SPRITE_DISK_CACHE_MAGIC));
+	*header.Append() = SPRITE_DISK_CACHE_VERSION;
+	AppendToSpriteDiskCacheHeader(header, _openttd_revision, strlen(_openttd_revision) + 1);
+	AppendToSpriteDiskCacheHeader(header, c.blitter, strlen(c.blitter) + 1);
+	AppendToSpriteDiskCacheHeader(header, c.md5sum, sizeof(c.md5sum));
+	for (uint i = 0; i < 8; i++) *header.Append() = GB(grf_size, i * 8, 8);
+	*header.Append() = remap ? 1 : 0;
+	*header.Append() = c.zoom_min;
+	*header.Append() = c.zoom_max;
+}
+
+/**
+ * Open the cache file of a slot for the current blitter and zoom levels,
+ * and find the sprites that were cached before.
+ * @param file_slot The slot of the GRF.
+ * @param c The cache file.
+ */
+static void OpenSpriteDiskCacheFile(uint8 file_slot, SpriteDiskCacheFile &c)
+{
+	CloseSpriteDiskCacheFile(c);
+	c.opened = true;
+	c.blitter = BlitterFactoryBase::GetCurrentBlitter()->GetName();
+	c.zoom_min = _settings_client.gui.zoom_min;
+	c.zoom_max = _settings_client.gui.zoom_max;
+
+	static const uint8 unknown[16] = { 0 };
+	if (memcmp(c.md5sum, unknown, sizeof(unknown)) == 0 || _personal_dir == NULL) return;
+
+	char dir[MAX_PATH];
+	seprintf(dir, lastof(dir), "%ssprite_cache" PATHSEP, _personal_dir);
+	FioCreateDirectory(dir);
+
+	char md5sum[33];
+	md5sumToString(md5sum, lastof(md5sum), c.md5sum);
+	bool remap = _palette_remap_grf[file_slot];
+	char filename[MAX_PATH];
+	seprintf(filename, lastof(filename), "%s%s-%s-%d%d%d.dat", dir, md5sum, c.blitter, remap ? 1 : 0, c.zoom_min, c.zoom_max);
+
+	/* What the file should start with; anything else means the file is outdated. */
+	SpriteDiskCacheHeader header;
+	GetSpriteDiskCacheHeader(header, c, FioGetFileSize(file_slot), remap);
+	size_t header_size = header.Length();
+
+	c.f = fopen(filename, "r+b");
+	if (c.f != NULL) {
+		byte *found = MallocT<byte>(header_size);
+		if (fread(found, 1, header_size, c.f) != header_size || memcmp(found, header.Begin(), header_size) != 0) {
+			fclose(c.f);
+			c.f = NULL;
+		}
+		free(found);
+	}
+
+	if (c.f == NULL) {
+		c.f = fopen(filename, "w+b");
+		if (c.f == NULL || fwrite(header.Begin(), 1, header_size, c.f) != header_size) {
+			DEBUG(sprite, 1, "Could not write sprite cache file %s", filename);
+			if (c.f != NULL) fclose(c.f);
+			c.f = NULL;
+			return;
+		}
+		c.end = header_size;
+		return;
+	}
+
+	c.map = FioMapFile(c.f, &c.map_size);
+
+	/* Index the sprites in the file; a sprite that was not completely written ends the file. */
+	fseek(c.f, 0, SEEK_END);
+	size_t file_size = ftell(c.f);
+	size_t pos = header_size;
+	byte entry[SPRITE_DISK_CACHE_ENTRY_HEADER];
+	while (pos + sizeof(entry) <= file_size && ReadSpriteDiskCacheData(c, pos, entry, sizeof(entry))) {
+		size_t file_pos = entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32)entry[3] << 24);
+		SpriteDiskCacheFile::Entry e;
+		e.pos = pos + sizeof(entry);
+		e.size = entry[5] | (entry[6] << 8) | (entry[7] << 16) | ((uint32)entry[8] << 24);
+		if (e.pos + e.size > file_size) break;
+
+		c.entries[GetSpriteDiskCacheKey(file_pos, (SpriteType)entry[4])] = e;
+		pos = e.pos + e.size;
+	}
+	c.end = pos;
+
+	DEBUG(sprite, 3, "Found %u cached sprites for %s in %s", (uint)c.entries.size(), FioGetFilename(file_slot), filename);
+}
+
+/**
+ * Get the cache file of a slot, (re)opening it when the blitter or zoom levels changed.
+ * @param file_slot The slot of the GRF.
+ * @return The cache file, or \c NULL when sprites of the slot are not cached.
+ */
+static SpriteDiskCacheFile *GetSpriteDiskCacheFile(uint8 file_slot)
+{
+	if (!_sprite_disk_cache) return NULL;
+
+	SpriteDiskCacheFile &c = _sprite_disk_cache_files[file_slot];
+	if (!c.opened || strcmp(c.blitter, BlitterFactoryBase::GetCurrentBlitter()->GetName()) != 0 ||
+			c.zoom_min != _settings_client.gui.zoom_min || c.zoom_max != _settings_client.gui.zoom_max) {
+		OpenSpriteDiskCacheFile(file_slot, c);
+	}
+	return c.f != NULL ? &c : NULL;
+}
+
+/**
+ * Tell which GRF is opened in a file slot, so its sprites can be found in the cache.
+ * @param file_slot The slot of the GRF.
+ * @param md5sum The MD5 sum of the GRF, or \c NULL when it is not known.
+ */
+void SetSpriteDiskCacheIdentity(uint8 file_slot, const uint8 *md5sum)
+{
+	SpriteDiskCacheFile &c = _sprite_disk_cache_files[file_slot];
+	CloseSpriteDiskCacheFile(c);
+	if (md5sum != NULL) {
+		memcpy(c.md5sum, md5sum, sizeof(c.md5sum));
+	} else {
+		memset(c.md5sum, 0, sizeof(c.md5sum));
+	}
+}
+
+/**
+ * Load an encoded sprite from the disk cache.
+ * @param file_slot The slot of the GRF the sprite is in.
+ * @param file_pos Position of the sprite in the GRF.
+ * @param type The type of the sprite.
+ * @param allocator Allocator of the memory for the sprite.
+ * @return The sprite, or \c NULL when it is not cached.
+ */
+void *LoadSpriteFromDiskCache(uint8 file_slot, size_t file_pos, SpriteType type, AllocatorProc *allocator)
+{
+	SpriteDiskCacheFile *c = GetSpriteDiskCacheFile(file_slot);
+	if (c == NULL) return NULL;
+
+	std::map<uint64, SpriteDiskCacheFile::Entry>::const_iterator it = c->entries.find(GetSpriteDiskCacheKey(file_pos, type));
+	if (it == c->entries.end()) return NULL;
+
+	const SpriteDiskCacheFile::Entry &e = it->second;
+	if (c->map != NULL && e.pos + e.size <= c->map_size) {
+		/* Straight from the mapping, so reading cannot fail halfway. */
+		void *sprite = allocator(e.size);
+		memcpy(sprite, c->map + e.pos, e.size);
+		return sprite;
+	}
+
+	byte *buffer = MallocT<byte>(e.size);
+	void *sprite = NULL;
+	if (ReadSpriteDiskCacheData(*c, e.pos, buffer, e.size)) {
+		sprite = allocator(e.size);
+		memcpy(sprite, buffer, e.size);
+	}
+	free(buffer);
+	return sprite;
+}
+
+/**
+ * Save an encoded sprite to the disk cache.
+ * @param file_slot The slot of the GRF the sprite is in.
+ * @param file_pos Position of the sprite in the GRF.
+ * @param type The type of the sprite.
+ * @param sprite The sprite as encoded by the blitter.
+ * @param size The size of the encoded sprite.
+ */
+void SaveSpriteToDiskCache(uint8 file_slot, size_t file_pos, SpriteType type, const void *sprite, size_t size)
+{
+	SpriteDiskCacheFile *c = GetSpriteDiskCacheFile(file_slot);
+	if (c == NULL) return;
+
+	uint64 key = GetSpriteDiskCacheKey(file_pos, type);
+	if (c->entries.find(key) != c->entries.end()) return;
+
+	byte entry[SPRITE_DISK_CACHE_ENTRY_HEADER] = {
+		(byte)GB(file_pos, 0, 8), (byte)GB(file_pos, 8, 8), (byte)GB(file_pos, 16, 8), (byte)GB(file_pos, 24, 8),
+		(byte)type,
+		(byte)GB(size, 0, 8), (byte)GB(size, 8, 8), (byte)GB(size, 16, 8), (byte)GB(size, 24, 8),
+	};
+	if (fseek(c->f, c->end, SEEK_SET) != 0 || fwrite(entry, 1, sizeof(entry), c->f) != sizeof(entry) || fwrite(sprite, 1, size, c->f) != size) {
+		/* Stop caching for this GRF; the incomplete sprite is ignored when the file is opened again. */
+		DEBUG(sprite, 1, "Could not write to the sprite cache of %s", FioGetFilename(file_slot));
+		CloseSpriteDiskCacheFile(*c);
+		c->opened = true;
+		return;
+	}
+
+	SpriteDiskCacheFile::Entry &e = c->entries[key];
+	e.pos = c->end + sizeof(entry);
+	e.size = (uint32)size;
+	c->end = e.pos + size;
+}
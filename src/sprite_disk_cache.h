@@ -0,0 +1,23 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file sprite_disk_cache.h Functions to cache sprites, as encoded by the blitter, on disk. */
+
+#ifndef SPRITE_DISK_CACHE_H
+#define SPRITE_DISK_CACHE_H
+
+#include "spritecache.h"
+
+extern bool _sprite_disk_cache;
+
+void SetSpriteDiskCacheIdentity(uint8 file_slot, const uint8 *md5sum);
+void *LoadSpriteFromDiskCache(uint8 file_slot, size_t file_pos, SpriteType type, AllocatorProc *allocator);
+void SaveSpriteToDiskCache(uint8 file_slot, size_t file_pos, SpriteType type, const void *sprite, size_t size);
+
+#endif /* SPRITE_DISK_CACHE_H */
@@ -18,23 +18,32 @@
 #include "blitter/factory.hpp"
 #include "core/math_func.hpp"
 #include "core/mem_func.hpp"
+#include "core/smallvec_type.hpp"
+#include "sprite_disk_cache.h"
 
 #include "table/sprites.h"
 #include "table/palette_convert.h"
 
 /* Default of 4MB spritecache */
 uint _sprite_cache_size = 4;
+uint _sprite_cache_size_max = 4; ///< Size the sprite cache may grow to when it is too small for what is drawn.
 
 typedef SimpleTinyEnumT<SpriteType, byte> SpriteTypeByte;
 
+/** Index of "no sprite" in the LRU list. */
+static const uint32 SPRITE_LRU_END = UINT32_MAX;
+
 struct SpriteCache {
 	void *ptr;
 	size_t file_pos;
 	uint32 id;
+	uint32 lru_prev;     ///< More recently used cached sprite, or #SPRITE_LRU_END.
+	uint32 lru_next;     ///< Less recently used cached sprite, or #SPRITE_LRU_END.
 	uint16 file_slot;
-	int16 lru;
+	uint16 last_used;    ///< Drawn frame in which the sprite was last requested, modulo 2^16.
 	SpriteTypeByte type; ///< In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
 	bool warned;         ///< True iff the user has been warned about incorrect use of this sprite
+	bool queued;         ///< Whether the sprite is in the prefetch queue.
 	byte container_ver;  ///< Container version of the GRF the sprite is from.
 };
 
@@ -72,18 +81,8 @@ static SpriteCache *AllocateSpriteCache(uint index)
 }
 
 
-struct MemBlock {
-	size_t size;
-	byte data[];
-};
-
-static uint _sprite_lru_counter;
-static MemBlock *_spritecache_ptr;
-static uint _allocated_sprite_cache_size = 0;
-static int _compact_cache_counter;
-
-static void CompactSpriteCache();
 static void *AllocSprite(size_t mem_req);
+static void DeleteEntryFromSpriteCache(uint item);
 
 /**
  * Skip the given amount of sprite graphics data.
@@ -367,6 +366,41 @@ static void *ReadRecolourSprite(uint16 file_slot, uint num)
 	return dest;
 }
 
+static AllocatorProc *_encode_allocator; ///< Allocator the sprite being encoded uses in the end.
+static size_t _encode_size;              ///< Size of the memory the blitter allocated for the sprite being encoded.
+
+/**
+ * Allocator that remembers how much memory the blitter needed, so the encoded sprite can be written to the disk cache.
+ * @param size The size of the allocation.
+ * @return The allocated memory.
+ */
+static void *RecordingAllocator(size_t size)
+{
+	_encode_size = size;
+	return _encode_allocator(size);
+}
+
+/**
+ * Encode a sprite for the current blitter, and save it to the disk cache when that is enabled.
+ * @param sprite    The sprite at all zoom levels.
+ * @param file_slot GRF the sprite is from.
+ * @param file_pos  Position of the sprite in the GRF.
+ * @param type      Type of sprite.
+ * @param allocator Allocator function to use.
+ * @return The encoded sprite.
+ */
+static void *EncodeSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType type, AllocatorProc *allocator)
+{
+	Blitter *blitter = BlitterFactoryBase::GetCurrentBlitter();
+	if (!_sprite_disk_cache) return blitter->Encode(sprite, allocator);
+
+	_encode_allocator = allocator;
+	_encode_size = 0;
+	void *encoded = blitter->Encode(sprite, &RecordingAllocator);
+	if (_encode_size != 0) SaveSpriteToDiskCache(file_slot, file_pos, type, encoded, _encode_size);
+	return encoded;
+}
+
 /**
  * Read a sprite from disk.
  * @param sc          Location of sprite.
@@ -386,6 +420,11 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 
 	DEBUG(sprite, 9, "Load sprite %d", id);
 
+	if (sprite_type != ST_MAPGEN) {
+		void *cached = LoadSpriteFromDiskCache(file_slot, file_pos, sprite_type, allocator);
+		if (cached != NULL) return cached;
+	}
+
 	SpriteLoader::Sprite sprite[ZOOM_LVL_COUNT];
 	uint8 sprite_avail = 0;
 	sprite[ZOOM_LVL_NORMAL].type = sprite_type;
@@ -439,7 +478,7 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 			return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
 		}
 	}
-	return BlitterFactoryBase::GetCurrentBlitter()->Encode(sprite, allocator);
+	return EncodeSprite(sprite, file_slot, file_pos, sprite_type, allocator);
 }
 
 
@@ -459,12 +498,17 @@ size_t GetGRFSpriteOffset(uint32 id)
 /**
  * Parse the sprite section of GRFs.
  * @param container_version Container version of the GRF we're currently processing.
+ * @param known_offsets The offsets of the sprite section when they are already known, e.g. from a #GRFFileIndex.
  */
-void ReadGRFSpriteOffsets(byte container_version)
+void ReadGRFSpriteOffsets(byte container_version, const std::map<uint32, size_t> *known_offsets)
 {
 	_grf_sprite_offsets.clear();
 
-	if (container_version >= 2) {
+	if (container_version >= 2 && known_offsets != NULL) {
+		/* Skip the offset of the sprite section. */
+		FioReadDword();
+		_grf_sprite_offsets = *known_offsets;
+	} else if (container_version >= 2) {
 		/* Seek to sprite section of the GRF. */
 		size_t data_offset = FioReadDword();
 		size_t old_pos = FioGetPos();
@@ -543,10 +587,11 @@ bool LoadNextSprite(int load_index, byte file_slot, uint file_sprite_id, byte co
 	}
 
 	SpriteCache *sc = AllocateSpriteCache(load_index);
+	if (sc->ptr != NULL) DeleteEntryFromSpriteCache(load_index);
 	sc->file_slot = file_slot;
 	sc->file_pos = file_pos;
 	sc->ptr = data;
-	sc->lru = 0;
+	sc->last_used = 0;
 	sc->id = file_sprite_id;
 	sc->type = type;
 	sc->warned = false;
@@ -561,6 +606,8 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	SpriteCache *scnew = AllocateSpriteCache(new_spr); // may reallocate: so put it first
 	SpriteCache *scold = GetSpriteCache(old_spr);
 
+	if (scnew->ptr != NULL) DeleteEntryFromSpriteCache(new_spr);
+
 	scnew->file_slot = scold->file_slot;
 	scnew->file_pos = scold->file_pos;
 	scnew->ptr = NULL;
@@ -570,106 +617,199 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	scnew->container_ver = scold->container_ver;
 }
 
-/**
- * S_FREE_MASK is used to mask-out lower bits of MemBlock::size
- * If they are non-zero, the block is free.
- * S_FREE_MASK has to ensure MemBlock is correctly aligned -
- * it means 8B (S_FREE_MASK == 7) on 64bit systems!
+/*
+ * Sprites are kept in blocks of a number of size classes. Blocks of a size
+ * class are carved out of slabs, so freeing and reusing them never needs
+ * moving other sprites; only sprites that are too big for the largest size
+ * class get an allocation of their own.
  */
-static const size_t S_FREE_MASK = sizeof(size_t) - 1;
 
-/* to make sure nobody adds things to MemBlock without checking S_FREE_MASK first */
-assert_compile(sizeof(MemBlock) == sizeof(size_t));
-/* make sure it's a power of two */
-assert_compile((sizeof(size_t) & (sizeof(size_t) - 1)) == 0);
+struct SpriteSlab;
 
-static inline MemBlock *NextBlock(MemBlock *block)
-{
-	return (MemBlock*)((byte*)block + (block->size & ~S_FREE_MASK));
-}
+/** Header in front of every block of sprite memory. */
+struct SpriteBlock {
+	SpriteSlab *slab;       ///< Slab the block is part of, or \c NULL when it is allocated on its own.
+	union {
+		size_t size;        ///< Size of the block, including this header, while it is in use.
+		SpriteBlock *next;  ///< Next free block of the slab, while it is free.
+	};
+};
+
+/** A slab of equally sized blocks of sprite memory. */
+struct SpriteSlab {
+	SpriteSlab *prev;       ///< Previous slab of the size class that has free blocks.
+	SpriteSlab *next;       ///< Next slab of the size class that has free blocks.
+	SpriteBlock *free;      ///< First block that was freed and not reused yet.
+	uint size_class;        ///< Size class of the blocks.
+	uint used;              ///< Number of blocks in use.
+	uint fresh;             ///< Number of blocks at the start of the slab that were ever handed out.
+	uint capacity;          ///< Number of blocks in the slab.
+};
 
-static size_t GetSpriteCacheUsage()
+/** The largest block that is carved out of a slab; bigger sprites are allocated on their own. */
+static const size_t MAX_SPRITE_SLAB_BLOCK = 32 * 1024;
+/** The minimum size of a slab. */
+static const size_t MIN_SPRITE_SLAB_SIZE = 64 * 1024;
+/** The minimum number of blocks in a slab. */
+static const uint MIN_SPRITE_SLAB_BLOCKS = 8;
+/** The maximum number of size classes. */
+static const uint MAX_SPRITE_SIZE_CLASSES = 64;
+
+/* Slabs and blocks must keep the sprite data aligned like malloc does for the blitters. */
+assert_compile(sizeof(SpriteBlock) % sizeof(size_t) == 0);
+assert_compile(sizeof(SpriteSlab) % sizeof(size_t) == 0);
+
+static size_t _sprite_size_classes[MAX_SPRITE_SIZE_CLASSES]; ///< Block sizes of the size classes, in increasing order.
+static uint _sprite_size_class_count;                        ///< Number of valid entries in #_sprite_size_classes.
+static SpriteSlab *_sprite_slabs[MAX_SPRITE_SIZE_CLASSES];   ///< Per size class the slabs that have free blocks.
+
+static uint32 _sprite_lru_head = SPRITE_LRU_END; ///< The most recently used cached sprite.
+static uint32 _sprite_lru_tail = SPRITE_LRU_END; ///< The least recently used cached sprite; the first to be evicted.
+static uint16 _sprite_cache_frame;               ///< Number of the frame that is being drawn, modulo 2^16.
+static bool _sprite_cache_thrashing;             ///< Whether a sprite requested in this or the previously drawn frame had to be evicted.
+static SpriteCacheStats _sprite_cache_stats;     ///< The statistics of the sprite cache.
+
+/** Maximum number of sprites waiting to be prefetched. */
+static const uint MAX_SPRITE_PREFETCH_QUEUE = 4096;
+/** Maximum number of sprites loaded by one call to #ProcessSpritePrefetchQueue. */
+static const uint MAX_SPRITE_PREFETCH_PER_LOOP = 64;
+
+static SmallVector<SpriteID, 256> _sprite_prefetch_queue; ///< Sprites that are likely to be drawn soon, the most likely last.
+
+/** Fill the size classes: about four per power of two, so at most a quarter of a block is wasted. */
+static void InitSpriteSizeClasses()
 {
-	size_t tot_size = 0;
-	MemBlock *s;
+	if (_sprite_size_class_count != 0) return;
 
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (!(s->size & S_FREE_MASK)) tot_size += s->size;
+	size_t size = 2 * sizeof(SpriteBlock);
+	while (size <= MAX_SPRITE_SLAB_BLOCK) {
+		assert(_sprite_size_class_count < MAX_SPRITE_SIZE_CLASSES);
+		_sprite_size_classes[_sprite_size_class_count++] = size;
+		size += max<size_t>(sizeof(SpriteBlock), (size_t)1 << FindLastBit(size / 4));
 	}
-
-	return tot_size;
 }
 
-
-void IncreaseSpriteLRU()
+/**
+ * Get the size class for a block.
+ * @param size The size of the block, including its header.
+ * @return The size class, or #_sprite_size_class_count when the block is too big for a slab.
+ */
+static uint GetSpriteSizeClass(size_t size)
 {
-	/* Increase all LRU values */
-	if (_sprite_lru_counter > 16384) {
-		SpriteID i;
-
-		DEBUG(sprite, 3, "Fixing lru %u, inuse=" PRINTF_SIZE, _sprite_lru_counter, GetSpriteCacheUsage());
-
-		for (i = 0; i != _spritecache_items; i++) {
-			SpriteCache *sc = GetSpriteCache(i);
-			if (sc->ptr != NULL) {
-				if (sc->lru >= 0) {
-					sc->lru = -1;
-				} else if (sc->lru != -32768) {
-					sc->lru--;
-				}
-			}
+	uint low = 0;
+	uint high = _sprite_size_class_count;
+	while (low < high) {
+		uint mid = (low + high) / 2;
+		if (_sprite_size_classes[mid] < size) {
+			low = mid + 1;
+		} else {
+			high = mid;
 		}
-		_sprite_lru_counter = 0;
 	}
+	return low;
+}
 
-	/* Compact sprite cache every now and then. */
-	if (++_compact_cache_counter >= 740) {
-		CompactSpriteCache();
-		_compact_cache_counter = 0;
-	}
+/**
+ * Get the number of bytes a slab of a size class takes.
+ * @param size_class The size class.
+ * @return The size of the slab.
+ */
+static size_t GetSpriteSlabSize(uint size_class)
+{
+	size_t blocks = max<size_t>(MIN_SPRITE_SLAB_BLOCKS, MIN_SPRITE_SLAB_SIZE / _sprite_size_classes[size_class]);
+	return sizeof(SpriteSlab) + blocks * _sprite_size_classes[size_class];
 }
 
 /**
- * Called when holes in the sprite cache should be removed.
- * That is accomplished by moving the cached data.
+ * Add a slab to the list of slabs with free blocks of its size class.
+ * @param slab The slab.
  */
-static void CompactSpriteCache()
+static void LinkSpriteSlab(SpriteSlab *slab)
 {
-	MemBlock *s;
+	SpriteSlab *&head = _sprite_slabs[slab->size_class];
+	slab->prev = NULL;
+	slab->next = head;
+	if (head != NULL) head->prev = slab;
+	head = slab;
+}
 
-	DEBUG(sprite, 3, "Compacting sprite cache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
+/**
+ * Remove a slab from the list of slabs with free blocks of its size class.
+ * @param slab The slab.
+ */
+static void UnlinkSpriteSlab(SpriteSlab *slab)
+{
+	if (slab->prev != NULL) {
+		slab->prev->next = slab->next;
+	} else {
+		_sprite_slabs[slab->size_class] = slab->next;
+	}
+	if (slab->next != NULL) slab->next->prev = slab->prev;
+}
 
-	for (s = _spritecache_ptr; s->size != 0;) {
-		if (s->size & S_FREE_MASK) {
-			MemBlock *next = NextBlock(s);
-			MemBlock temp;
-			SpriteID i;
+/**
+ * Add a cached sprite to the front of the LRU list.
+ * @param item The sprite.
+ */
+static void LinkSpriteLRU(uint item)
+{
+	SpriteCache *sc = GetSpriteCache(item);
+	sc->lru_prev = SPRITE_LRU_END;
+	sc->lru_next = _sprite_lru_head;
+	if (_sprite_lru_head != SPRITE_LRU_END) {
+		GetSpriteCache(_sprite_lru_head)->lru_prev = item;
+	} else {
+		_sprite_lru_tail = item;
+	}
+	_sprite_lru_head = item;
+}
 
-			/* Since free blocks are automatically coalesced, this should hold true. */
-			assert(!(next->size & S_FREE_MASK));
+/**
+ * Remove a cached sprite from the LRU list.
+ * @param item The sprite.
+ */
+static void UnlinkSpriteLRU(uint item)
+{
+	SpriteCache *sc = GetSpriteCache(item);
+	if (sc->lru_prev != SPRITE_LRU_END) {
+		GetSpriteCache(sc->lru_prev)->lru_next = sc->lru_next;
+	} else {
+		_sprite_lru_head = sc->lru_next;
+	}
+	if (sc->lru_next != SPRITE_LRU_END) {
+		GetSpriteCache(sc->lru_next)->lru_prev = sc->lru_prev;
+	} else {
+		_sprite_lru_tail = sc->lru_prev;
+	}
+}
 
-			/* If the next block is the sentinel block, we can safely return */
-			if (next->size == 0) break;
+/**
+ * Free the memory of a sprite.
+ * @param ptr The sprite, as returned by #AllocSprite.
+ */
+static void FreeSprite(void *ptr)
+{
+	SpriteBlock *block = (SpriteBlock *)ptr - 1;
+	SpriteSlab *slab = block->slab;
+
+	if (slab == NULL) {
+		_sprite_cache_stats.used -= block->size;
+		_sprite_cache_stats.reserved -= block->size;
+		free(block);
+		return;
+	}
 
-			/* Locate the sprite belonging to the next pointer. */
-			for (i = 0; GetSpriteCache(i)->ptr != next->data; i++) {
-				assert(i != _spritecache_items);
-			}
+	_sprite_cache_stats.used -= _sprite_size_classes[slab->size_class];
 
-			GetSpriteCache(i)->ptr = s->data; // Adjust sprite array entry
-			/* Swap this and the next block */
-			temp = *s;
-			memmove(s, next, next->size);
-			s = NextBlock(s);
-			*s = temp;
+	block->next = slab->free;
+	slab->free = block;
+	if (slab->used-- == slab->capacity) LinkSpriteSlab(slab);
 
-			/* Coalesce free blocks */
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		} else {
-			s = NextBlock(s);
-		}
+	/* Keep one slab per size class around, so a size class that is used a bit does not keep allocating and freeing slabs. */
+	if (slab->used == 0 && (slab->prev != NULL || slab->next != NULL)) {
+		UnlinkSpriteSlab(slab);
+		_sprite_cache_stats.reserved -= GetSpriteSlabSize(slab->size_class);
+		free(slab);
 	}
 }
 
@@ -679,80 +819,111 @@ static void CompactSpriteCache()
  */
 static void DeleteEntryFromSpriteCache(uint item)
 {
-	/* Mark the block as free (the block must be in use) */
-	MemBlock *s = (MemBlock*)GetSpriteCache(item)->ptr - 1;
-	assert(!(s->size & S_FREE_MASK));
-	s->size |= S_FREE_MASK;
-	GetSpriteCache(item)->ptr = NULL;
-
-	/* And coalesce adjacent free blocks */
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (s->size & S_FREE_MASK) {
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		}
-	}
+	SpriteCache *sc = GetSpriteCache(item);
+	assert(sc->ptr != NULL);
+
+	if (sc->type != ST_RECOLOUR) UnlinkSpriteLRU(item);
+	FreeSprite(sc->ptr);
+	sc->ptr = NULL;
 }
 
-static void DeleteEntryFromSpriteCache()
+/**
+ * Evict the least recently used sprite from the sprite cache.
+ * @return False when there is no sprite that can be evicted.
+ */
+static bool EvictSpriteFromSpriteCache()
 {
-	uint best = UINT_MAX;
-	int cur_lru;
+	uint item = _sprite_lru_tail;
+	if (item == SPRITE_LRU_END) return false;
 
-	DEBUG(sprite, 3, "DeleteEntryFromSpriteCache, inuse=" PRINTF_SIZE, GetSpriteCacheUsage());
+	/* A sprite that was needed very recently is likely needed again right away. */
+	if ((uint16)(_sprite_cache_frame - GetSpriteCache(item)->last_used) <= 1) _sprite_cache_thrashing = true;
 
-	cur_lru = 0xffff;
-	for (SpriteID i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != NULL && sc->lru < cur_lru) {
-			cur_lru = sc->lru;
-			best = i;
-		}
-	}
-
-	/* Display an error message and die, in case we found no sprite at all.
-	 * This shouldn't really happen, unless all sprites are locked. */
-	if (best == UINT_MAX) error("Out of sprite memory");
-
-	DeleteEntryFromSpriteCache(best);
+	DeleteEntryFromSpriteCache(item);
+	_sprite_cache_stats.evictions++;
+	return true;
 }
 
 static void *AllocSprite(size_t mem_req)
 {
-	mem_req += sizeof(MemBlock);
+	mem_req = Align(mem_req + sizeof(SpriteBlock), sizeof(SpriteBlock));
 
-	/* Align this to correct boundary. This also makes sure at least one
-	 * bit is not used, so we can use it for other things. */
-	mem_req = Align(mem_req, S_FREE_MASK + 1);
+	uint size_class = GetSpriteSizeClass(mem_req);
+	size_t size = size_class < _sprite_size_class_count ? _sprite_size_classes[size_class] : mem_req;
 
-	for (;;) {
-		MemBlock *s;
+	/* Make room within the budget. When everything left is locked, the budget is exceeded instead. */
+	while (_sprite_cache_stats.used + size > _sprite_cache_stats.budget) {
+		if (!EvictSpriteFromSpriteCache()) break;
+	}
 
-		for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-			if (s->size & S_FREE_MASK) {
-				size_t cur_size = s->size & ~S_FREE_MASK;
+	SpriteBlock *block;
+	if (size_class == _sprite_size_class_count) {
+		block = (SpriteBlock *)MallocT<byte>(size);
+		block->slab = NULL;
+		_sprite_cache_stats.reserved += size;
+	} else {
+		SpriteSlab *slab = _sprite_slabs[size_class];
+		if (slab == NULL) {
+			size_t slab_size = GetSpriteSlabSize(size_class);
+			slab = (SpriteSlab *)MallocT<byte>(slab_size);
+			slab->free = NULL;
+			slab->size_class = size_class;
+			slab->used = 0;
+			slab->fresh = 0;
+			slab->capacity = (uint)((slab_size - sizeof(SpriteSlab)) / size);
+			LinkSpriteSlab(slab);
+			_sprite_cache_stats.reserved += slab_size;
+		}
 
-				/* Is the block exactly the size we need or
-				 * big enough for an additional free block? */
-				if (cur_size == mem_req ||
-						cur_size >= mem_req + sizeof(MemBlock)) {
-					/* Set size and in use */
-					s->size = mem_req;
+		if (slab->free != NULL) {
+			block = slab->free;
+			slab->free = block->next;
+		} else {
+			block = (SpriteBlock *)((byte *)(slab + 1) + slab->fresh++ * size);
+		}
+		if (++slab->used == slab->capacity) UnlinkSpriteSlab(slab);
+		block->slab = slab;
+	}
 
-					/* Do we need to inject a free block too? */
-					if (cur_size != mem_req) {
-						NextBlock(s)->size = (cur_size - mem_req) | S_FREE_MASK;
-					}
+	block->size = size;
+	_sprite_cache_stats.used += size;
+	return block + 1;
+}
 
-					return s->data;
-				}
-			}
-		}
+/**
+ * Advance the frame of the sprite cache after a frame has been drawn, and
+ * give the sprite cache more room when it could not hold the sprites of
+ * the last frames.
+ */
+void IncreaseSpriteLRU()
+{
+	_sprite_cache_frame++;
 
-		/* Reached sentinel, but no block found yet. Delete some old entry. */
-		DeleteEntryFromSpriteCache();
-	}
+	if (!_sprite_cache_thrashing) return;
+	_sprite_cache_thrashing = false;
+
+	if (_sprite_cache_stats.budget >= _sprite_cache_stats.ceiling) return;
+
+	_sprite_cache_stats.budget = min(_sprite_cache_stats.ceiling, _sprite_cache_stats.budget + max<size_t>(_sprite_cache_stats.budget / 4, 1024 * 1024));
+	DEBUG(sprite, 3, "Sprite cache is too small, growing it to " PRINTF_SIZE " bytes; in use: " PRINTF_SIZE, _sprite_cache_stats.budget, _sprite_cache_stats.used);
+}
+
+/**
+ * Get the statistics of the sprite cache.
+ * @return The statistics.
+ */
+const SpriteCacheStats &GetSpriteCacheStats()
+{
+	return _sprite_cache_stats;
+}
+
+/** Reset the hit, miss and eviction counters of the sprite cache. */
+void ResetSpriteCacheStats()
+{
+	_sprite_cache_stats.hits = 0;
+	_sprite_cache_stats.misses = 0;
+	_sprite_cache_stats.evictions = 0;
+	_sprite_cache_stats.prefetches = 0;
 }
 
 /**
@@ -826,12 +997,22 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 
 	if (allocator == NULL) {
 		/* Load sprite into/from spritecache */
-
-		/* Update LRU */
-		sc->lru = ++_sprite_lru_counter;
+		sc->last_used = _sprite_cache_frame;
+
+		if (sc->ptr != NULL) {
+			_sprite_cache_stats.hits++;
+			/* Recolour sprites are never evicted, so they are not in the LRU list. */
+			if (type != ST_RECOLOUR && _sprite_lru_head != sprite) {
+				UnlinkSpriteLRU(sprite);
+				LinkSpriteLRU(sprite);
+			}
+			return sc->ptr;
+		}
 
 		/* Load the sprite, if it is not loaded, yet */
-		if (sc->ptr == NULL) sc->ptr = ReadSprite(sc, sprite, type, AllocSprite);
+		_sprite_cache_stats.misses++;
+		sc->ptr = ReadSprite(sc, sprite, type, AllocSprite);
+		if (type != ST_RECOLOUR) LinkSpriteLRU(sprite);
 
 		return sc->ptr;
 	} else {
@@ -840,35 +1021,77 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 	}
 }
 
+/**
+ * Queue a sprite that is likely to be drawn soon, so #ProcessSpritePrefetchQueue can
+ * load it into the sprite cache before it is needed.
+ * @param sprite The sprite to prefetch.
+ */
+void PrefetchSprite(SpriteID sprite)
+{
+	if (!SpriteExists(sprite)) return;
 
-static void GfxInitSpriteCache()
+	SpriteCache *sc = GetSpriteCache(sprite);
+	if (sc->ptr != NULL || sc->queued || sc->type != ST_NORMAL) return;
+	if (_sprite_prefetch_queue.Length() >= MAX_SPRITE_PREFETCH_QUEUE) return;
+
+	sc->queued = true;
+	*_sprite_prefetch_queue.Append() = sprite;
+}
+
+/**
+ * Load some of the queued sprites into the sprite cache, the most recently queued first.
+ * Prefetching stops when it would push out sprites that are still being drawn.
+ */
+void ProcessSpritePrefetchQueue()
 {
-	/* initialize sprite cache heap */
-	int bpp = BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth();
-	uint target_size = (bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+	for (uint i = 0; i < MAX_SPRITE_PREFETCH_PER_LOOP && _sprite_prefetch_queue.Length() != 0; i++) {
+		if (_sprite_cache_stats.used + _sprite_cache_stats.budget / 16 > _sprite_cache_stats.budget &&
+				_sprite_lru_tail != SPRITE_LRU_END && (uint16)(_sprite_cache_frame - GetSpriteCache(_sprite_lru_tail)->last_used) <= 1) {
+			break;
+		}
+
+		SpriteID sprite = *(_sprite_prefetch_queue.End() - 1);
+		_sprite_prefetch_queue.Erase(_sprite_prefetch_queue.End() - 1);
+
+		SpriteCache *sc = GetSpriteCache(sprite);
+		sc->queued = false;
+		if (sc->ptr != NULL || sc->type != ST_NORMAL) continue;
 
-	if (_spritecache_ptr == NULL || _allocated_sprite_cache_size != target_size) {
-		free(_spritecache_ptr);
-		_allocated_sprite_cache_size = target_size;
-		_spritecache_ptr = (MemBlock*)MallocT<byte>(_allocated_sprite_cache_size);
+		sc->ptr = ReadSprite(sc, sprite, ST_NORMAL, AllocSprite);
+		/* Not drawn yet, so evicting it again does not mean the cache is too small. */
+		sc->last_used = _sprite_cache_frame - 2;
+		LinkSpriteLRU(sprite);
+		_sprite_cache_stats.prefetches++;
 	}
+}
+
+
+static void GfxInitSpriteCache()
+{
+	InitSpriteSizeClasses();
 
-	/* A big free block */
-	_spritecache_ptr->size = (_allocated_sprite_cache_size - sizeof(MemBlock)) | S_FREE_MASK;
-	/* Sentinel block (identified by size == 0) */
-	NextBlock(_spritecache_ptr)->size = 0;
+	/* The budget starts at the configured size and may grow up to the configured maximum. */
+	int bpp = BlitterFactoryBase::GetCurrentBlitter()->GetScreenDepth();
+	_sprite_cache_stats.budget = (size_t)(bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+	_sprite_cache_stats.ceiling = max(_sprite_cache_stats.budget, (size_t)(bpp > 0 ? _sprite_cache_size_max * bpp / 8 : 1) * 1024 * 1024);
+	_sprite_cache_thrashing = false;
 }
 
 void GfxInitSpriteMem()
 {
+	/* Free all sprites, including the recolour sprites. */
+	for (uint i = 0; i != _spritecache_items; i++) {
+		if (GetSpriteCache(i)->ptr != NULL) DeleteEntryFromSpriteCache(i);
+	}
+	assert(_sprite_lru_head == SPRITE_LRU_END);
+	_sprite_prefetch_queue.Clear();
+
 	GfxInitSpriteCache();
 
 	/* Reset the spritecache 'pool' */
 	free(_spritecache);
 	_spritecache_items = 0;
 	_spritecache = NULL;
-
-	_compact_cache_counter = 0;
 }
 
 /**
@@ -878,10 +1101,7 @@ void GfxInitSpriteMem()
 void GfxClearSpriteCache()
 {
 	/* Clear sprite ptr for all cached items */
-	for (uint i = 0; i != _spritecache_items; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->type != ST_RECOLOUR && sc->ptr != NULL) DeleteEntryFromSpriteCache(i);
-	}
+	while (_sprite_lru_head != SPRITE_LRU_END) DeleteEntryFromSpriteCache(_sprite_lru_head);
 }
 
 /* static */ ReusableBuffer<SpriteLoader::CommonPixel> SpriteLoader::Sprite::buffer[ZOOM_LVL_COUNT];
@@ -13,6 +13,7 @@
 #define SPRITECACHE_H
 
 #include "gfx_type.h"
+#include <map>
 
 /** Data structure describing a sprite. */
 struct Sprite {
@@ -24,6 +25,19 @@ struct Sprite {
 };
 
 extern uint _sprite_cache_size;
+extern uint _sprite_cache_size_max;
+
+/** Statistics of the sprite cache. */
+struct SpriteCacheStats {
+	uint64 hits;       ///< Number of requests for sprites that were cached.
+	uint64 misses;     ///< Number of requests for sprites that had to be loaded.
+	uint64 evictions;  ///< Number of sprites removed to make room for other sprites.
+	uint64 prefetches; ///< Number of sprites loaded ahead of being drawn.
+	size_t used;       ///< Bytes taken by the cached sprites.
+	size_t reserved;   ///< Bytes allocated for the cached sprites, including free blocks in slabs.
+	size_t budget;     ///< Bytes the cached sprites may currently take.
+	size_t ceiling;    ///< Bytes the budget may grow to.
+};
 
 typedef void *AllocatorProc(size_t size);
 
@@ -50,8 +64,12 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
 void IncreaseSpriteLRU();
+const SpriteCacheStats &GetSpriteCacheStats();
+void ResetSpriteCacheStats();
+void PrefetchSprite(SpriteID sprite);
+void ProcessSpritePrefetchQueue();
 
-void ReadGRFSpriteOffsets(byte container_version);
+void ReadGRFSpriteOffsets(byte container_version, const std::map<uint32, size_t> *known_offsets = NULL);
 size_t GetGRFSpriteOffset(uint32 id);
 bool LoadNextSprite(int load_index, byte file_index, uint file_sprite_id, byte container_version);
 bool SkipSpriteData(byte type, uint16 num);
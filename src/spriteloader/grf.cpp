@@ -52,28 +52,57 @@ static bool WarnCorruptSprite(uint8 file_slot, size_t file_pos, int line)
 	return false;
 }
 
+/** Reads the compressed data of a sprite from the current file through the Fio buffer. */
+struct FioSpriteReader {
+	/**
+	 * Read the next byte of the compressed data.
+	 * @return The read byte.
+	 */
+	inline byte ReadByte()
+	{
+		return FioReadByte();
+	}
+};
+
+/** Reads the compressed data of a sprite directly from the memory mapped file. */
+struct MappedSpriteReader {
+	const byte *data; ///< The next byte to read.
+	const byte *end;  ///< The end of the mapped data.
+
+	/**
+	 * Create the reader.
+	 * @param data The mapped data at the start of the compressed data.
+	 * @param size Number of bytes that can be read from \a data.
+	 */
+	MappedSpriteReader(const byte *data, size_t size) : data(data), end(data + size) {}
+
+	/**
+	 * Read the next byte of the compressed data.
+	 * @return The read byte, or 0 at the end of the file like #FioReadByte.
+	 */
+	inline byte ReadByte()
+	{
+		return this->data < this->end ? *this->data++ : 0;
+	}
+};
+
 /**
- * Decode the image data of a single sprite.
- * @param[in,out] sprite Filled with the sprite image data.
- * @param file_slot File slot.
- * @param file_pos File position.
- * @param sprite_type Type of the sprite we're decoding.
- * @param num Size of the decompressed sprite.
- * @param type Type of the encoded sprite.
- * @param zoom_lvl Requested zoom level.
- * @param colour_fmt Colour format of the sprite.
- * @param container_format Container format of the GRF this sprite is in.
- * @return True if the sprite was successfully loaded.
+ * Decompress the data of a sprite.
+ * @param reader Source of the compressed data.
+ * @param dest_orig Buffer for the decompressed data.
+ * @param num Size of the decompressed data.
+ * @param file_slot File slot, for warnings.
+ * @param file_pos File position, for warnings.
+ * @return True if the data was successfully decompressed.
  */
-bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, int64 num, byte type, ZoomLevel zoom_lvl, byte colour_fmt, byte container_format)
+template <class Treader>
+static bool DecompressSprite(Treader &reader, byte *dest_orig, int64 num, uint8 file_slot, size_t file_pos)
 {
-	AutoFreePtr<byte> dest_orig(MallocT<byte>(num));
 	byte *dest = dest_orig;
-	const int64 dest_size = num;
 
 	/* Read the file, which has some kind of compression */
 	while (num > 0) {
-		int8 code = FioReadByte();
+		int8 code = reader.ReadByte();
 
 		if (code >= 0) {
 			/* Plain bytes to read */
@@ -81,12 +110,12 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 			num -= size;
 			if (num < 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
 			for (; size > 0; size--) {
-				*dest = FioReadByte();
+				*dest = reader.ReadByte();
 				dest++;
 			}
 		} else {
 			/* Copy bytes from earlier in the sprite */
-			const uint data_offset = ((code & 7) << 8) | FioReadByte();
+			const uint data_offset = ((code & 7) << 8) | reader.ReadByte();
 			if (dest - data_offset < dest_orig) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
 			int size = -(code >> 3);
 			num -= size;
@@ -99,6 +128,40 @@ bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t fi
 	}
 
 	if (num != 0) return WarnCorruptSprite(file_slot, file_pos, __LINE__);
+	return true;
+}
+
+/**
+ * Decode the image data of a single sprite.
+ * @param[in,out] sprite Filled with the sprite image data.
+ * @param file_slot File slot.
+ * @param file_pos File position.
+ * @param sprite_type Type of the sprite we're decoding.
+ * @param num Size of the decompressed sprite.
+ * @param type Type of the encoded sprite.
+ * @param zoom_lvl Requested zoom level.
+ * @param colour_fmt Colour format of the sprite.
+ * @param container_format Container format of the GRF this sprite is in.
+ * @return True if the sprite was successfully loaded.
+ */
+bool DecodeSingleSprite(SpriteLoader::Sprite *sprite, uint8 file_slot, size_t file_pos, SpriteType sprite_type, int64 num, byte type, ZoomLevel zoom_lvl, byte colour_fmt, byte container_format)
+{
+	AutoFreePtr<byte> dest_orig(MallocT<byte>(num));
+	byte *dest;
+	const int64 dest_size = num;
+
+	/* Decompress straight from the file's memory when it is mapped. */
+	size_t available;
+	const byte *mapped = FioGetMappedData(&available);
+	if (mapped != NULL) {
+		MappedSpriteReader reader(mapped, available);
+		bool decompressed = DecompressSprite(reader, dest_orig, num, file_slot, file_pos);
+		FioSkipBytes(reader.data - mapped);
+		if (!decompressed) return false;
+	} else {
+		FioSpriteReader reader;
+		if (!DecompressSprite(reader, dest_orig, num, file_slot, file_pos)) return false;
+	}
 
 	sprite->AllocateData(zoom_lvl, sprite->width * sprite->height);
 
@@ -24,6 +24,7 @@
 #include "roadstop_base.h"
 #include "industry.h"
 #include "core/random_func.hpp"
+#include "spatial_index.h"
 
 #include "table/strings.h"
 
@@ -118,6 +119,8 @@ Station::~Station()
 	}
 
 	CargoPacket::InvalidateAllFrom(this->index);
+
+	if (!this->indexed_rect.IsEmpty()) _station_rect_index.Remove(this->index, this->indexed_rect);
 }
 
 
@@ -329,6 +332,9 @@ static bool FindIndustryToDeliver(TileIndex ind_tile, void *user_data)
  */
 void Station::RecomputeIndustriesNear()
 {
+	/* The station's tiles changed, so its registration in the rect index may have too. */
+	this->UpdateRectIndex();
+
 	this->industries_near.Clear();
 	if (this->rect.IsEmpty()) return;
 
@@ -347,6 +353,20 @@ void Station::RecomputeIndustriesNear()
 	CircularTileSearch(&start_tile, 2 * max_radius + 1, &FindIndustryToDeliver, &riv);
 }
 
+/**
+ * Update the registration of the station in the rect index after its
+ * #rect changed.
+ */
+void Station::UpdateRectIndex()
+{
+	const StationRect &old = this->indexed_rect;
+	if (old.left == this->rect.left && old.top == this->rect.top && old.right == this->rect.right && old.bottom == this->rect.bottom) return;
+
+	if (!this->indexed_rect.IsEmpty()) _station_rect_index.Remove(this->index, this->indexed_rect);
+	this->indexed_rect = this->rect;
+	if (!this->indexed_rect.IsEmpty()) _station_rect_index.Add(this->index, this->indexed_rect);
+}
+
 /**
  * Recomputes Station::industries_near for all stations
  */
@@ -17,6 +17,7 @@
 #include "cargopacket.h"
 #include "industry_type.h"
 #include "newgrf_storage.h"
+#include <list>
 
 typedef Pool<BaseStation, StationID, 32, 64000> StationPool;
 extern StationPool _station_pool;
@@ -288,6 +289,7 @@ public:
 	uint32 always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
 	IndustryVector industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
+	StationRect indexed_rect;       ///< NOSAVE: #rect as registered in the station rect index, @see FindStationsAroundTiles()
 
 	Station(TileIndex tile = INVALID_TILE);
 	~Station();
@@ -302,6 +304,7 @@ public:
 	/* virtual */ uint GetPlatformLength(TileIndex tile) const;
 	void RecomputeIndustriesNear();
 	static void RecomputeIndustriesNearForAll();
+	void UpdateRectIndex();
 
 	uint GetCatchmentRadius() const;
 	Rect GetCatchmentRect() const;
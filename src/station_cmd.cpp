@@ -44,6 +44,7 @@
 #include "pbs.h"
 #include "debug.h"
 #include "core/random_func.hpp"
+#include "core/sort_func.hpp"
 #include "company_base.h"
 #include "table/airporttile_ids.h"
 #include "newgrf_airporttiles.h"
@@ -51,6 +52,7 @@
 #include "newgrf_house.h"
 #include "company_gui.h"
 #include "widgets/station_widget.h"
+#include "spatial_index.h"
 
 #include "table/strings.h"
 
@@ -2221,6 +2223,7 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 
 			if (AirportTileSpec::Get(GetTranslatedAirportTileID(iter.GetStationGfx()))->animation.status != ANIM_STATUS_NO_ANIMATION) AddAnimatedTile(iter);
 		}
+		_airport_spatial_index.Add(st->index, st->airport.tile);
 
 		/* Only call the animation trigger after all tiles have been built */
 		for (AirportTileTableIterator iter(as->table[layout], tile); iter != INVALID_TILE; ++iter) {
@@ -2310,6 +2313,7 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 
 		st->rect.AfterRemoveRect(st, st->airport);
 
+		_airport_spatial_index.Remove(st->index, st->airport.tile);
 		st->airport.Clear();
 		st->facilities &= ~FACIL_AIRPORT;
 
@@ -3434,9 +3438,30 @@ CommandCost CmdRenameStation(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	return CommandCost();
 }
 
+/** A station found by #FindStationsAroundTiles with the first of its tiles in the search area. */
+struct StationAroundTiles {
+	TileIndex first_tile; ///< First tile of the station in the search area, in row-major order.
+	Station *st;          ///< The station.
+};
+
+/**
+ * Sort stations by the first of their tiles in the search area.
+ * @param a First station.
+ * @param b Second station.
+ * @return Order of the stations.
+ */
+static int CDECL StationAroundTilesSorter(const StationAroundTiles *a, const StationAroundTiles *b)
+{
+	return (int)a->first_tile - (int)b->first_tile;
+}
+
 /**
  * Find all stations around a rectangular producer (industry, house, headquarter, ...)
  *
+ * The candidate stations are taken from the station rect index, after which only
+ * the tiles of each candidate inside the search area are checked. The stations
+ * are added in the order a scan over all tiles of the search area would find them.
+ *
  * @param location The location/area of the producer
  * @param stations The list to store the stations in
  */
@@ -3458,30 +3483,50 @@ void FindStationsAroundTiles(const TileArea &location, StationList *stations)
 	if (max_x >= MapSizeX()) max_x = MapSizeX() - 1;
 	if (max_y >= MapSizeY()) max_y = MapSizeY() - 1;
 
-	for (uint cy = min_y; cy < max_y; cy++) {
-		for (uint cx = min_x; cx < max_x; cx++) {
-			TileIndex cur_tile = TileXY(cx, cy);
-			if (!IsTileType(cur_tile, MP_STATION)) continue;
-
-			Station *st = Station::GetByTile(cur_tile);
-			/* st can be NULL in case of waypoints */
-			if (st == NULL) continue;
-
-			if (_settings_game.station.modified_catchment) {
-				int rad = st->GetCatchmentRadius();
-				int rad_x = cx - x;
-				int rad_y = cy - y;
-
-				if (rad_x < -rad || rad_x >= rad + location.w) continue;
-				if (rad_y < -rad || rad_y >= rad + location.h) continue;
+	if (min_x >= max_x || min_y >= max_y) return;
+
+	Rect area = { (int)min_x, (int)min_y, (int)max_x - 1, (int)max_y - 1 };
+	SmallVector<StationID, 16> candidates;
+	_station_rect_index.FindOverlapping(area, candidates);
+	if (candidates.Length() == 0) return;
+
+	SmallVector<StationAroundTiles, 16> found;
+	for (const StationID *id = candidates.Begin(); id != candidates.End(); id++) {
+		Station *st = Station::Get(*id);
+
+		/* Tiles of the station that are inside the area and within its catchment radius. */
+		int rad = _settings_game.station.modified_catchment ? st->GetCatchmentRadius() : max_rad;
+		int left   = max(max<int>(min_x, (int)x - rad), st->rect.left);
+		int right  = min(min<int>(max_x, x + location.w + rad) - 1, st->rect.right);
+		int top    = max(max<int>(min_y, (int)y - rad), st->rect.top);
+		int bottom = min(min<int>(max_y, y + location.h + rad) - 1, st->rect.bottom);
+
+		for (int cy = top; cy <= bottom; cy++) {
+			TileIndex first_tile = INVALID_TILE;
+			for (int cx = left; cx <= right; cx++) {
+				TileIndex cur_tile = TileXY(cx, cy);
+				if (IsTileType(cur_tile, MP_STATION) && GetStationIndex(cur_tile) == st->index) {
+					first_tile = cur_tile;
+					break;
+				}
 			}
+			if (first_tile == INVALID_TILE) continue;
 
-			/* Insert the station in the set. This will fail if it has
-			 * already been added.
-			 */
-			stations->Include(st);
+			StationAroundTiles *sat = found.Append();
+			sat->first_tile = first_tile;
+			sat->st = st;
+			break;
 		}
 	}
+
+	QSortT(found.Begin(), found.Length(), &StationAroundTilesSorter);
+
+	for (const StationAroundTiles *sat = found.Begin(); sat != found.End(); sat++) {
+		/* Insert the station in the set. This will fail if it has
+		 * already been added.
+		 */
+		stations->Include(sat->st);
+	}
 }
 
 /**
@@ -3584,6 +3629,7 @@ void BuildOilRig(TileIndex tile)
 	st->airport.Add(tile);
 	st->dock_tile = tile;
 	st->facilities = FACIL_AIRPORT | FACIL_DOCK;
+	_airport_spatial_index.Add(st->index, tile);
 	st->build_date = _date;
 
 	st->rect.BeforeAddTile(tile, StationRect::ADD_FORCE);
@@ -3599,6 +3645,7 @@ void DeleteOilRig(TileIndex tile)
 
 	MakeWaterKeepingClass(tile, OWNER_NONE);
 
+	_airport_spatial_index.Remove(st->index, st->airport.tile);
 	st->dock_tile = INVALID_TILE;
 	st->airport.Clear();
 	st->facilities &= ~(FACIL_AIRPORT | FACIL_DOCK);
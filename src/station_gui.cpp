@@ -150,11 +150,12 @@ protected:
 	static bool include_empty;            // whether we should include stations without waiting cargo
 	static const uint32 cargo_filter_max;
 	static uint32 cargo_filter;           // bitmap of cargo types to include
-	static const Station *last_station;
+	static GUIListStrings station_names;  // names of the stations, when sorting by name
 
 	/* Constants for sorting stations */
 	static const StringID sorter_names[];
 	static GUIStationList::SortFunction * const sorter_funcs[];
+	static GUIStationList::SortKeyFunction * const sort_key_funcs[];
 
 	GUIStationList stations;
 	Scrollbar *vscroll;
@@ -203,19 +204,19 @@ protected:
 	/** Sort stations by their name */
 	static int CDECL StationNameSorter(const Station * const *a, const Station * const *b)
 	{
-		static char buf_cache[64];
-		char buf[64];
-
-		SetDParam(0, (*a)->index);
-		GetString(buf, STR_STATION_NAME, lastof(buf));
+		return strcmp(station_names.Get((*a)->index), station_names.Get((*b)->index));
+	}
 
-		if (*b != last_station) {
-			last_station = *b;
-			SetDParam(0, (*b)->index);
-			GetString(buf_cache, STR_STATION_NAME, lastof(buf_cache));
+	/** Determine the names of the stations, before sorting them by their name */
+	static void CDECL StationNameSortKeys(const Station * const *stations, uint count)
+	{
+		station_names.Clear();
+		for (uint i = 0; i < count; i++) {
+			char buf[64];
+			SetDParam(0, stations[i]->index);
+			GetString(buf, STR_STATION_NAME, lastof(buf));
+			station_names.Set(stations[i]->index, buf);
 		}
-
-		return strcmp(buf, buf_cache);
 	}
 
 	/** Sort stations by their type */
@@ -273,9 +274,6 @@ protected:
 	{
 		if (!this->stations.Sort()) return;
 
-		/* Reset name sorter sort cache */
-		this->last_station = NULL;
-
 		/* Set the modified widget dirty */
 		this->SetWidgetDirty(WID_STL_LIST);
 	}
@@ -284,7 +282,7 @@ public:
 	CompanyStationsWindow(const WindowDesc *desc, WindowNumber window_number) : Window()
 	{
 		this->stations.SetListing(this->last_sorting);
-		this->stations.SetSortFuncs(this->sorter_funcs);
+		this->stations.SetSortFuncs(this->sorter_funcs, this->sort_key_funcs);
 		this->stations.ForceRebuild();
 		this->stations.NeedResort();
 		this->SortStationsList();
@@ -634,7 +632,7 @@ byte CompanyStationsWindow::facilities = FACIL_TRAIN | FACIL_TRUCK_STOP | FACIL_
 bool CompanyStationsWindow::include_empty = true;
 const uint32 CompanyStationsWindow::cargo_filter_max = UINT32_MAX;
 uint32 CompanyStationsWindow::cargo_filter = UINT32_MAX;
-const Station *CompanyStationsWindow::last_station = NULL;
+GUIListStrings CompanyStationsWindow::station_names;
 
 /* Availible station sorting functions */
 GUIStationList::SortFunction * const CompanyStationsWindow::sorter_funcs[] = {
@@ -645,6 +643,15 @@ GUIStationList::SortFunction * const CompanyStationsWindow::sorter_funcs[] = {
 	&StationRatingMinSorter
 };
 
+/* Functions determining the sort keys of the station sorting functions */
+GUIStationList::SortKeyFunction * const CompanyStationsWindow::sort_key_funcs[] = {
+	&StationNameSortKeys,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
 /* Names of the sorting functions */
 const StringID CompanyStationsWindow::sorter_names[] = {
 	STR_SORT_BY_NAME,
@@ -2011,11 +2011,6 @@ const char *GetCurrentLanguageIsoCode()
 bool MissingGlyphSearcher::FindMissingGlyphs(const char **str)
 {
 	InitFreeType(this->Monospace());
-	const Sprite *question_mark[FS_END];
-
-	for (FontSize size = this->Monospace() ? FS_MONO : FS_BEGIN; size < (this->Monospace() ? FS_END : FS_MONO); size++) {
-		question_mark[size] = GetGlyph(size, '?');
-	}
 
 	this->Reset();
 	for (const char *text = this->NextString(); text != NULL; text = this->NextString()) {
@@ -2033,7 +2028,7 @@ bool MissingGlyphSearcher::FindMissingGlyphs(const char **str)
 				size = FS_SMALL;
 			} else if (c == SCC_BIGFONT) {
 				size = FS_LARGE;
-			} else if (!IsInsideMM(c, SCC_SPRITE_START, SCC_SPRITE_END) && IsPrintable(c) && !IsTextDirectionChar(c) && c != '?' && GetGlyph(size, c) == question_mark[size]) {
+			} else if (!IsInsideMM(c, SCC_SPRITE_START, SCC_SPRITE_END) && IsPrintable(c) && !IsTextDirectionChar(c) && c != '?' && !HasGlyph(size, c)) {
 				/* The character is printable, but not in the normal font. This is the case we were testing for. */
 				return true;
 			}
@@ -2088,6 +2083,36 @@ class LanguagePackGlyphSearcher : public MissingGlyphSearcher {
 	}
 };
 
+#ifdef WITH_FREETYPE
+/**
+ * Queue the glyphs of all characters used by the language pack, so they
+ * are rendered in the background instead of when they are first drawn.
+ * @param searcher The searcher that goes through the strings of the language pack.
+ */
+static void PrefetchLanguageGlyphs(MissingGlyphSearcher *searcher)
+{
+	ClearGlyphPrefetchQueue();
+
+	searcher->Reset();
+	for (const char *text = searcher->NextString(); text != NULL; text = searcher->NextString()) {
+		FontSize size = searcher->DefaultSize();
+		for (WChar c = Utf8Consume(&text); c != '\0'; c = Utf8Consume(&text)) {
+			if (c == SCC_SETX) {
+				text++;
+			} else if (c == SCC_SETXY) {
+				text += 2;
+			} else if (c == SCC_TINYFONT) {
+				size = FS_SMALL;
+			} else if (c == SCC_BIGFONT) {
+				size = FS_LARGE;
+			} else if (IsPrintable(c) && !IsTextDirectionChar(c)) {
+				PrefetchGlyph(size, c);
+			}
+		}
+	}
+}
+#endif /* WITH_FREETYPE */
+
 /**
  * Check whether the currently loaded language pack
  * uses characters that the currently loaded font
@@ -2142,6 +2167,10 @@ void CheckForMissingGlyphs(bool base_font, MissingGlyphSearcher *searcher)
 		return;
 	}
 
+#ifdef WITH_FREETYPE
+	if (searcher == &pack_searcher) PrefetchLanguageGlyphs(searcher);
+#endif /* WITH_FREETYPE */
+
 	/* Update the font with cache */
 	LoadStringWidthTable(searcher->Monospace());
 
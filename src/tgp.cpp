@@ -243,15 +243,17 @@ static inline bool IsValidXY(uint x, uint y)
 
 
 /**
- * Allocate array of (MapSizeX()+1)*(MapSizeY()+1) heights and init the _height_map structure members
+ * Allocate array of (size_x+1)*(size_y+1) heights and init the _height_map structure members
+ * @param size_x Number of tiles along the x axis.
+ * @param size_y Number of tiles along the y axis.
  * @return true on success
  */
-static inline bool AllocHeightMap()
+static inline bool AllocHeightMap(uint size_x, uint size_y)
 {
 	height_t *h;
 
-	_height_map.size_x = MapSizeX();
-	_height_map.size_y = MapSizeY();
+	_height_map.size_x = size_x;
+	_height_map.size_y = size_y;
 
 	/* Allocate memory block for height map row pointers */
 	_height_map.total_size = (_height_map.size_x + 1) * (_height_map.size_y + 1);
@@ -430,83 +432,114 @@ static int *HeightMapMakeHistogram(height_t h_min, height_t h_max, int *hist_buf
 	return hist;
 }
 
-/** Applies sine wave redistribution onto height map */
-static void HeightMapSineTransform(height_t h_min, height_t h_max)
+/**
+ * Apply the sine wave redistribution to a height.
+ * @param height The height to transform.
+ * @param h_min The lowest height to transform.
+ * @param h_max The highest height after the transformation, exclusive.
+ * @return The transformed height.
+ */
+static height_t SineTransformHeight(height_t height, height_t h_min, height_t h_max)
 {
-	height_t *h;
-
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		double fheight;
-
-		if (*h < h_min) continue;
-
-		/* Transform height into 0..1 space */
-		fheight = (double)(*h - h_min) / (double)(h_max - h_min);
-		/* Apply sine transform depending on landscape type */
-		switch (_settings_game.game_creation.landscape) {
-			case LT_TOYLAND:
-			case LT_TEMPERATE:
-				/* Move and scale 0..1 into -1..+1 */
-				fheight = 2 * fheight - 1;
-				/* Sine transform */
-				fheight = sin(fheight * M_PI_2);
-				/* Transform it back from -1..1 into 0..1 space */
-				fheight = 0.5 * (fheight + 1);
-				break;
-
-			case LT_ARCTIC:
-				{
-					/* Arctic terrain needs special height distribution.
-					 * Redistribute heights to have more tiles at highest (75%..100%) range */
-					double sine_upper_limit = 0.75;
-					double linear_compression = 2;
-					if (fheight >= sine_upper_limit) {
-						/* Over the limit we do linear compression up */
-						fheight = 1.0 - (1.0 - fheight) / linear_compression;
-					} else {
-						double m = 1.0 - (1.0 - sine_upper_limit) / linear_compression;
-						/* Get 0..sine_upper_limit into -1..1 */
-						fheight = 2.0 * fheight / sine_upper_limit - 1.0;
-						/* Sine wave transform */
-						fheight = sin(fheight * M_PI_2);
-						/* Get -1..1 back to 0..(1 - (1 - sine_upper_limit) / linear_compression) == 0.0..m */
-						fheight = 0.5 * (fheight + 1.0) * m;
-					}
+	/* Transform height into 0..1 space */
+	double fheight = (double)(height - h_min) / (double)(h_max - h_min);
+	/* Apply sine transform depending on landscape type */
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TOYLAND:
+		case LT_TEMPERATE:
+			/* Move and scale 0..1 into -1..+1 */
+			fheight = 2 * fheight - 1;
+			/* Sine transform */
+			fheight = sin(fheight * M_PI_2);
+			/* Transform it back from -1..1 into 0..1 space */
+			fheight = 0.5 * (fheight + 1);
+			break;
+
+		case LT_ARCTIC:
+			{
+				/* Arctic terrain needs special height distribution.
+				 * Redistribute heights to have more tiles at highest (75%..100%) range */
+				double sine_upper_limit = 0.75;
+				double linear_compression = 2;
+				if (fheight >= sine_upper_limit) {
+					/* Over the limit we do linear compression up */
+					fheight = 1.0 - (1.0 - fheight) / linear_compression;
+				} else {
+					double m = 1.0 - (1.0 - sine_upper_limit) / linear_compression;
+					/* Get 0..sine_upper_limit into -1..1 */
+					fheight = 2.0 * fheight / sine_upper_limit - 1.0;
+					/* Sine wave transform */
+					fheight = sin(fheight * M_PI_2);
+					/* Get -1..1 back to 0..(1 - (1 - sine_upper_limit) / linear_compression) == 0.0..m */
+					fheight = 0.5 * (fheight + 1.0) * m;
 				}
-				break;
-
-			case LT_TROPIC:
-				{
-					/* Desert terrain needs special height distribution.
-					 * Half of tiles should be at lowest (0..25%) heights */
-					double sine_lower_limit = 0.5;
-					double linear_compression = 2;
-					if (fheight <= sine_lower_limit) {
-						/* Under the limit we do linear compression down */
-						fheight = fheight / linear_compression;
-					} else {
-						double m = sine_lower_limit / linear_compression;
-						/* Get sine_lower_limit..1 into -1..1 */
-						fheight = 2.0 * ((fheight - sine_lower_limit) / (1.0 - sine_lower_limit)) - 1.0;
-						/* Sine wave transform */
-						fheight = sin(fheight * M_PI_2);
-						/* Get -1..1 back to (sine_lower_limit / linear_compression)..1.0 */
-						fheight = 0.5 * ((1.0 - m) * fheight + (1.0 + m));
-					}
+			}
+			break;
+
+		case LT_TROPIC:
+			{
+				/* Desert terrain needs special height distribution.
+				 * Half of tiles should be at lowest (0..25%) heights */
+				double sine_lower_limit = 0.5;
+				double linear_compression = 2;
+				if (fheight <= sine_lower_limit) {
+					/* Under the limit we do linear compression down */
+					fheight = fheight / linear_compression;
+				} else {
+					double m = sine_lower_limit / linear_compression;
+					/* Get sine_lower_limit..1 into -1..1 */
+					fheight = 2.0 * ((fheight - sine_lower_limit) / (1.0 - sine_lower_limit)) - 1.0;
+					/* Sine wave transform */
+					fheight = sin(fheight * M_PI_2);
+					/* Get -1..1 back to (sine_lower_limit / linear_compression)..1.0 */
+					fheight = 0.5 * ((1.0 - m) * fheight + (1.0 + m));
 				}
-				break;
+			}
+			break;
 
-			default:
-				NOT_REACHED();
-				break;
-		}
-		/* Transform it back into h_min..h_max space */
-		*h = (height_t)(fheight * (h_max - h_min) + h_min);
-		if (*h < 0) *h = I2H(0);
-		if (*h >= h_max) *h = h_max - 1;
+		default:
+			NOT_REACHED();
+			break;
+	}
+	/* Transform it back into h_min..h_max space */
+	height = (height_t)(fheight * (h_max - h_min) + h_min);
+	if (height < 0) height = I2H(0);
+	if (height >= h_max) height = h_max - 1;
+	return height;
+}
+
+/** Data of the pass applying the sine wave redistribution. */
+struct SineTransformData {
+	height_t h_min;        ///< The lowest height to transform.
+	height_t h_max;        ///< The highest height after the transformation, exclusive.
+	const height_t *table; ///< The transformed heights, indexed by the height minus \c h_min.
+};
+
+/** Applies sine wave redistribution onto a band of rows of the height map. */
+static void HeightMapSineTransformRows(uint first, uint last, void *data)
+{
+	const SineTransformData *sd = (const SineTransformData *)data;
+
+	for (height_t *h = &_height_map.height(0, first); h < &_height_map.height(0, last); h++) {
+		if (*h < sd->h_min) continue;
+		*h = *h <= sd->h_max ? sd->table[*h - sd->h_min] : SineTransformHeight(*h, sd->h_min, sd->h_max);
 	}
 }
 
+/** Applies sine wave redistribution onto height map */
+static void HeightMapSineTransform(height_t h_min, height_t h_max)
+{
+	/* There are only a few heights, so transform each of them once. */
+	SineTransformData sd;
+	sd.h_min = h_min;
+	sd.h_max = h_max;
+	height_t *table = AllocaM(height_t, h_max - h_min + 1);
+	for (height_t h = h_min; h <= h_max; h++) table[h - h_min] = SineTransformHeight(h, h_min, h_max);
+	sd.table = table;
+
+	GenerateWorldRowsInParallel(_height_map.size_y + 1, &HeightMapSineTransformRows, &sd);
+}
+
 /* Additional map variety is provided by applying different curve maps
  * to different parts of the map. A randomized low resolution grid contains
  * which curve map to use on each part of the make. This filtered non-linearly
@@ -557,97 +590,188 @@ static const control_point_list_t _curve_maps[] = {
 	{ lengthof(_curve_map_4), _curve_map_4 },
 };
 
-static void HeightMapCurves(uint level)
-{
-	height_t ht[lengthof(_curve_maps)];
-
-	/* Set up a grid to choose curve maps based on location */
-	uint sx = Clamp(1 << level, 2, 32);
-	uint sy = Clamp(1 << level, 2, 32);
-	byte *c = (byte *)alloca(sx * sy);
+/** Highest height, exclusive, the curve maps are looked up for in advance. */
+static const height_t CURVE_MAP_TABLE_SIZE = 256;
+
+/** Data of the pass applying the curve maps. */
+struct CurvesData {
+	uint sx;               ///< Number of grid cells along the x axis.
+	const byte *c;         ///< The curve map of each grid cell.
+	const uint *x1;        ///< Per x the first grid cell along the x axis.
+	const uint *x2;        ///< Per x the second grid cell along the x axis.
+	const float *xr;       ///< Per x the ratio of the second grid cell.
+	const float *xri;      ///< Per x the ratio of the first grid cell.
+	const uint *y1;        ///< Per y the first grid cell along the y axis.
+	const uint *y2;        ///< Per y the second grid cell along the y axis.
+	const float *yr;       ///< Per y the ratio of the second grid cell.
+	const float *yri;      ///< Per y the ratio of the first grid cell.
+	height_t ht_table[lengthof(_curve_maps)][CURVE_MAP_TABLE_SIZE]; ///< Per curve map the curved heights.
+	bool ht_valid[lengthof(_curve_maps)][CURVE_MAP_TABLE_SIZE];     ///< Per curve map whether a height is on the curve.
+};
 
-	for (uint i = 0; i < sx * sy; i++) {
-		c[i] = Random() % lengthof(_curve_maps);
+/**
+ * Get the bi-linear grid positions and ratio of a position along an axis.
+ * @param pos The position along the axis.
+ * @param size The size of the map along the axis.
+ * @param cells The number of grid cells along the axis.
+ * @param[out] p1 The first grid cell.
+ * @param[out] p2 The second grid cell.
+ * @param[out] r The ratio of the second grid cell.
+ * @param[out] ri The ratio of the first grid cell.
+ */
+static void GetCurveGridPosition(uint pos, uint size, uint cells, uint *p1, uint *p2, float *r, float *ri)
+{
+	float f = (float)(cells * pos) / size + 0.5f;
+	*p1 = (uint)f;
+	*p2 = *p1;
+	*r = 2.0f * (f - *p1) - 1.0f;
+	*r = sin(*r * M_PI_2);
+	*r = sin(*r * M_PI_2);
+	*r = 0.5f * (*r + 1.0f);
+	*ri = 1.0f - *r;
+
+	if (*p1 > 0) {
+		(*p1)--;
+		if (*p2 >= cells) (*p2)--;
 	}
+}
 
-	/* Apply curves */
-	for (uint x = 0; x < _height_map.size_x; x++) {
-
-		/* Get our X grid positions and bi-linear ratio */
-		float fx = (float)(sx * x) / _height_map.size_x + 0.5f;
-		uint x1 = (uint)fx;
-		uint x2 = x1;
-		float xr = 2.0f * (fx - x1) - 1.0f;
-		xr = sin(xr * M_PI_2);
-		xr = sin(xr * M_PI_2);
-		xr = 0.5f * (xr + 1.0f);
-		float xri = 1.0f - xr;
-
-		if (x1 > 0) {
-			x1--;
-			if (x2 >= sx) x2--;
-		}
+/** Applies the curve maps onto a band of rows of the height map. */
+static void HeightMapCurvesRows(uint first, uint last, void *data)
+{
+	const CurvesData *cd = (const CurvesData *)data;
+	height_t ht[lengthof(_curve_maps)];
+	MemSetT(ht, 0, lengthof(ht));
 
-		for (uint y = 0; y < _height_map.size_y; y++) {
-
-			/* Get our Y grid position and bi-linear ratio */
-			float fy = (float)(sy * y) / _height_map.size_y + 0.5f;
-			uint y1 = (uint)fy;
-			uint y2 = y1;
-			float yr = 2.0f * (fy - y1) - 1.0f;
-			yr = sin(yr * M_PI_2);
-			yr = sin(yr * M_PI_2);
-			yr = 0.5f * (yr + 1.0f);
-			float yri = 1.0f - yr;
-
-			if (y1 > 0) {
-				y1--;
-				if (y2 >= sy) y2--;
-			}
+	for (uint y = first; y < last; y++) {
+		uint y1 = cd->y1[y];
+		uint y2 = cd->y2[y];
+		float yr = cd->yr[y];
+		float yri = cd->yri[y];
 
-			uint corner_a = c[x1 + sx * y1];
-			uint corner_b = c[x1 + sx * y2];
-			uint corner_c = c[x2 + sx * y1];
-			uint corner_d = c[x2 + sx * y2];
+		height_t *h = &_height_map.height(0, y);
+		for (uint x = 0; x < _height_map.size_x; x++, h++) {
+			uint corner_a = cd->c[cd->x1[x] + cd->sx * y1];
+			uint corner_b = cd->c[cd->x1[x] + cd->sx * y2];
+			uint corner_c = cd->c[cd->x2[x] + cd->sx * y1];
+			uint corner_d = cd->c[cd->x2[x] + cd->sx * y2];
 
 			/* Bitmask of which curve maps are chosen, so that we do not bother
-			 * calculating a curve which won't be used. */
+			 * looking up a curve which won't be used. */
 			uint corner_bits = 0;
 			corner_bits |= 1 << corner_a;
 			corner_bits |= 1 << corner_b;
 			corner_bits |= 1 << corner_c;
 			corner_bits |= 1 << corner_d;
 
-			height_t *h = &_height_map.height(x, y);
-
 			/* Apply all curve maps that are used on this tile. */
-			for (uint t = 0; t < lengthof(_curve_maps); t++) {
-				if (!HasBit(corner_bits, t)) continue;
-
-				const control_point_t *cm = _curve_maps[t].list;
-				for (uint i = 0; i < _curve_maps[t].length - 1; i++) {
-					const control_point_t &p1 = cm[i];
-					const control_point_t &p2 = cm[i + 1];
-
-					if (*h >= p1.x && *h < p2.x) {
-						ht[t] = p1.y + (*h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
-						break;
-					}
+			if (*h >= 0 && *h < CURVE_MAP_TABLE_SIZE) {
+				for (uint t = 0; t < lengthof(_curve_maps); t++) {
+					if (HasBit(corner_bits, t) && cd->ht_valid[t][*h]) ht[t] = cd->ht_table[t][*h];
 				}
 			}
 
 			/* Apply interpolation of curve map results. */
-			*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
+			*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * cd->xri[x] + (ht[corner_c] * yri + ht[corner_d] * yr) * cd->xr[x]);
 		}
 	}
 }
 
+static void HeightMapCurves(uint level)
+{
+	CurvesData *cd = CallocT<CurvesData>(1);
+
+	/* Set up a grid to choose curve maps based on location */
+	uint sx = Clamp(1 << level, 2, 32);
+	uint sy = Clamp(1 << level, 2, 32);
+	byte *c = (byte *)alloca(sx * sy);
+
+	for (uint i = 0; i < sx * sy; i++) {
+		c[i] = Random() % lengthof(_curve_maps);
+	}
+	cd->sx = sx;
+	cd->c = c;
+
+	/* Get our X and Y grid positions and bi-linear ratios; they are the same for every row and column. */
+	uint *x1 = MallocT<uint>(_height_map.size_x);
+	uint *x2 = MallocT<uint>(_height_map.size_x);
+	float *xr = MallocT<float>(_height_map.size_x);
+	float *xri = MallocT<float>(_height_map.size_x);
+	for (uint x = 0; x < _height_map.size_x; x++) {
+		GetCurveGridPosition(x, _height_map.size_x, sx, &x1[x], &x2[x], &xr[x], &xri[x]);
+	}
+	cd->x1 = x1;
+	cd->x2 = x2;
+	cd->xr = xr;
+	cd->xri = xri;
+
+	uint *y1 = MallocT<uint>(_height_map.size_y);
+	uint *y2 = MallocT<uint>(_height_map.size_y);
+	float *yr = MallocT<float>(_height_map.size_y);
+	float *yri = MallocT<float>(_height_map.size_y);
+	for (uint y = 0; y < _height_map.size_y; y++) {
+		GetCurveGridPosition(y, _height_map.size_y, sy, &y1[y], &y2[y], &yr[y], &yri[y]);
+	}
+	cd->y1 = y1;
+	cd->y2 = y2;
+	cd->yr = yr;
+	cd->yri = yri;
+
+	/* Look up the curve maps for all heights once, instead of for every tile. */
+	for (uint t = 0; t < lengthof(_curve_maps); t++) {
+		const control_point_t *cm = _curve_maps[t].list;
+		for (uint i = 0; i < _curve_maps[t].length - 1; i++) {
+			const control_point_t &p1 = cm[i];
+			const control_point_t &p2 = cm[i + 1];
+
+			for (height_t h = max<height_t>(p1.x, 0); h < p2.x && h < CURVE_MAP_TABLE_SIZE; h++) {
+				if (cd->ht_valid[t][h]) continue;
+				cd->ht_table[t][h] = p1.y + (h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+				cd->ht_valid[t][h] = true;
+			}
+		}
+	}
+
+	/* Apply curves */
+	GenerateWorldRowsInParallel(_height_map.size_y, &HeightMapCurvesRows, cd);
+
+	free(x1);
+	free(x2);
+	free(xr);
+	free(xri);
+	free(y1);
+	free(y2);
+	free(yr);
+	free(yri);
+	free(cd);
+}
+
+/** Data of the pass moving the heights to the water level. */
+struct WaterLevelData {
+	height_t h_water_level; ///< The height that becomes the water level.
+	height_t h_max;         ///< The highest height before the transformation.
+	height_t h_max_new;     ///< The highest height after the transformation, exclusive.
+};
+
+/** Transforms a band of rows of the height map so the water level becomes height 0. */
+static void HeightMapAdjustWaterLevelRows(uint first, uint last, void *data)
+{
+	const WaterLevelData *wd = (const WaterLevelData *)data;
+
+	for (height_t *h = &_height_map.height(0, first); h < &_height_map.height(0, last); h++) {
+		/* Transform height from range h_water_level..h_max into 0..h_max_new range */
+		*h = (height_t)(((int)wd->h_max_new) * (*h - wd->h_water_level) / (wd->h_max - wd->h_water_level)) + I2H(1);
+		/* Make sure all values are in the proper range (0..h_max_new) */
+		if (*h < 0) *h = I2H(0);
+		if (*h >= wd->h_max_new) *h = wd->h_max_new - 1;
+	}
+}
+
 /** Adjusts heights in height map to contain required amount of water tiles */
 static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_new)
 {
 	height_t h_min, h_max, h_avg, h_water_level;
 	int64 water_tiles, desired_water_tiles;
-	height_t *h;
 	int *hist;
 
 	HeightMapGetMinMaxAvg(&h_min, &h_max, &h_avg);
@@ -672,13 +796,11 @@ static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_
 	 *   values from range: h_water_level..h_max are transformed into 0..h_max_new
 	 *   where h_max_new is 4, 8, 12 or 16 depending on terrain type (very flat, flat, hilly, mountains)
 	 */
-	FOR_ALL_TILES_IN_HEIGHT(h) {
-		/* Transform height from range h_water_level..h_max into 0..h_max_new range */
-		*h = (height_t)(((int)h_max_new) * (*h - h_water_level) / (h_max - h_water_level)) + I2H(1);
-		/* Make sure all values are in the proper range (0..h_max_new) */
-		if (*h < 0) *h = I2H(0);
-		if (*h >= h_max_new) *h = h_max_new - 1;
-	}
+	WaterLevelData wd;
+	wd.h_water_level = h_water_level;
+	wd.h_max = h_max;
+	wd.h_max_new = h_max_new;
+	GenerateWorldRowsInParallel(_height_map.size_y + 1, &HeightMapAdjustWaterLevelRows, &wd);
 
 	free(hist_buf);
 }
@@ -956,6 +1078,19 @@ static void TgenSetTileHeight(TileIndex tile, int height)
 	}
 }
 
+/** Transfer a band of rows of the height map into the OTTD map. */
+static void TgenSetTileHeightRows(uint first, uint last, void *data)
+{
+	for (uint y = first; y < last; y++) {
+		for (uint x = 0; x < _height_map.size_x; x++) {
+			int height = H2I(_height_map.height(x, y));
+			if (height < 0) height = 0;
+			if (height > 15) height = 15;
+			TgenSetTileHeight(TileXY(x, y), height);
+		}
+	}
+}
+
 /**
  * The main new land generator using Perlin noise. Desert landscape is handled
  * different to all others to give a desert valley between two high mountains.
@@ -967,7 +1102,7 @@ void GenerateTerrainPerlin()
 {
 	uint x, y;
 
-	if (!AllocHeightMap()) return;
+	if (!AllocHeightMap(MapSizeX(), MapSizeY())) return;
 	GenerateWorldSetAbortCallback(FreeHeightMap);
 
 	HeightMapGenerate();
@@ -985,17 +1120,40 @@ void GenerateTerrainPerlin()
 	}
 
 	/* Transfer height map into OTTD map */
-	for (y = 0; y < _height_map.size_y; y++) {
-		for (x = 0; x < _height_map.size_x; x++) {
-			int height = H2I(_height_map.height(x, y));
-			if (height < 0) height = 0;
-			if (height > 15) height = 15;
-			TgenSetTileHeight(TileXY(x, y), height);
-		}
-	}
+	GenerateWorldRowsInParallel(_height_map.size_y, &TgenSetTileHeightRows, NULL);
 
 	IncreaseGeneratingWorldProgress(GWP_LANDSCAPE);
 
 	FreeHeightMap();
 	GenerateWorldSetAbortCallback(NULL);
 }
+
+/**
+ * Generate the height map for a map of a given size, without touching the
+ * actual map or the state of the game, to measure the speed of the generator.
+ * @param size_x Number of tiles along the x axis.
+ * @param size_y Number of tiles along the y axis.
+ * @param seed The seed of the generator.
+ * @return Checksum of the generated heights; the same seed and size should always give the same checksum.
+ */
+uint32 BenchmarkTerrainPerlin(uint size_x, uint size_y, uint32 seed)
+{
+	SavedRandomSeeds saved_seeds;
+	SaveRandomSeeds(&saved_seeds);
+	SetRandomSeed(seed);
+	uint32 saved_generation_seed = _settings_game.game_creation.generation_seed;
+	_settings_game.game_creation.generation_seed = seed;
+
+	AllocHeightMap(size_x, size_y);
+	HeightMapGenerate();
+	HeightMapNormalize();
+
+	uint32 checksum = 0;
+	height_t *h;
+	FOR_ALL_TILES_IN_HEIGHT(h) checksum = ROL(checksum, 3) ^ (uint16)*h;
+
+	FreeHeightMap();
+	_settings_game.game_creation.generation_seed = saved_generation_seed;
+	RestoreRandomSeeds(saved_seeds);
+	return checksum;
+}
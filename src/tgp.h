@@ -13,5 +13,6 @@
 #define TGP_H
 
 void GenerateTerrainPerlin();
+uint32 BenchmarkTerrainPerlin(uint size_x, uint size_y, uint32 seed);
 
 #endif /* TGP_H */
@@ -94,4 +94,15 @@ public:
  */
 uint GetCPUCoreCount();
 
+/**
+ * A part of some work that is spread over threads by #RunParallel.
+ * Usually a part takes every \a parts-th item, starting with item \a part.
+ * @param part The part to do.
+ * @param parts The number of parts the work is split in.
+ * @param data Data of the work.
+ */
+typedef void ParallelProc(uint part, uint parts, void *data);
+
+void RunParallel(uint parts, ParallelProc *proc, void *data);
+
 #endif /* THREAD_H */
@@ -0,0 +1,69 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file thread_parallel.cpp Spreading work over threads. */
+
+#include "../stdafx.h"
+#include "../core/alloc_func.hpp"
+#include "thread.h"
+
+/** One part of the work of #RunParallel. */
+struct ParallelJob {
+	ParallelProc *proc; ///< The work.
+	void *data;         ///< Data of the work.
+	uint part;          ///< The part to do.
+	uint parts;         ///< The number of parts.
+};
+
+/**
+ * Do the part of the work of a job.
+ * @param data The #ParallelJob.
+ */
+static void DoParallelJob(void *data)
+{
+	const ParallelJob *job = (const ParallelJob *)data;
+	job->proc(job->part, job->parts, job->data);
+}
+
+/**
+ * Do some work split in parts, each part on its own thread, and wait till
+ * all parts are done. The current thread does the first part. Parts for
+ * which no thread can be started are done on the current thread as well.
+ * @param parts The number of parts; usually no more than #GetCPUCoreCount.
+ * @param proc The work.
+ * @param data Data of the work.
+ */
+void RunParallel(uint parts, ParallelProc *proc, void *data)
+{
+	assert(parts > 0);
+
+	ParallelJob *jobs = AllocaM(ParallelJob, parts);
+	ThreadObject **threads = AllocaM(ThreadObject *, parts);
+	for (uint i = 0; i < parts; i++) {
+		jobs[i].proc = proc;
+		jobs[i].data = data;
+		jobs[i].part = i;
+		jobs[i].parts = parts;
+		threads[i] = NULL;
+	}
+
+	for (uint i = 1; i < parts; i++) {
+		if (!ThreadObject::New(&DoParallelJob, &jobs[i], &threads[i])) {
+			threads[i] = NULL;
+			DoParallelJob(&jobs[i]);
+		}
+	}
+	DoParallelJob(&jobs[0]);
+
+	for (uint i = 1; i < parts; i++) {
+		if (threads[i] == NULL) continue;
+		threads[i]->Join();
+		delete threads[i];
+	}
+}
@@ -109,7 +109,7 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 	 * Creates a new town.
 	 * @param tile center tile of the town
 	 */
-	Town(TileIndex tile = INVALID_TILE) : xy(tile) { }
+	Town(TileIndex tile = INVALID_TILE);
 
 	/** Destroy the town. */
 	~Town();
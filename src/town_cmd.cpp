@@ -46,6 +46,7 @@
 #include "object_base.h"
 #include "ai/ai.hpp"
 #include "game/game.hpp"
+#include "spatial_index.h"
 
 #include "table/strings.h"
 #include "table/town_land.h"
@@ -57,6 +58,15 @@ uint32 _town_cargoes_accepted; ///< Bitmap of all cargoes accepted by houses.
 TownPool _town_pool("Town");
 INSTANTIATE_POOL_METHODS(Town)
 
+/**
+ * Create a new town.
+ * @param tile The centre tile of the town.
+ */
+Town::Town(TileIndex tile) : xy(tile)
+{
+	if (tile != INVALID_TILE) _town_spatial_index.Add(this->index, tile);
+}
+
 Town::~Town()
 {
 	free(this->name);
@@ -96,6 +106,8 @@ Town::~Town()
 		}
 	}
 
+	_town_spatial_index.Remove(this->index, this->xy);
+
 	/* Clear the persistent storage list. */
 	this->psa_list.clear();
 
@@ -339,12 +351,8 @@ static void AnimateTile_Town(TileIndex tile)
  */
 static bool IsCloseToTown(TileIndex tile, uint dist)
 {
-	const Town *t;
-
-	FOR_ALL_TOWNS(t) {
-		if (DistanceManhattan(tile, t->xy) < dist) return true;
-	}
-	return false;
+	TownID index;
+	return _town_spatial_index.FindNearest(tile, SM_MANHATTAN, dist, SpatialAcceptAll(), index);
 }
 
 /**
@@ -3126,19 +3134,9 @@ CommandCost CheckIfAuthorityAllowsNewStation(TileIndex tile, DoCommandFlag flags
  */
 Town *CalcClosestTownFromTile(TileIndex tile, uint threshold)
 {
-	Town *t;
-	uint best = threshold;
-	Town *best_town = NULL;
-
-	FOR_ALL_TOWNS(t) {
-		uint dist = DistanceManhattan(tile, t->xy);
-		if (dist < best) {
-			best = dist;
-			best_town = t;
-		}
-	}
-
-	return best_town;
+	TownID index;
+	if (!_town_spatial_index.FindNearest(tile, SM_MANHATTAN, threshold, SpatialAcceptAll(), index)) return NULL;
+	return Town::Get(index);
 }
 
 /**
@@ -627,10 +627,11 @@ struct TownDirectoryWindow : public Window {
 private:
 	/* Runtime saved values */
 	static Listing last_sorting;
-	static const Town *last_town;
+	static GUIListStrings town_names;
 
 	/* Constants for sorting towns */
 	static GUITownList::SortFunction * const sorter_funcs[];
+	static GUITownList::SortKeyFunction * const sort_key_funcs[];
 
 	GUITownList towns;
 
@@ -651,31 +652,25 @@ private:
 			this->vscroll->SetCount(this->towns.Length()); // Update scrollbar as well.
 		}
 		/* Always sort the towns. */
-		this->last_town = NULL;
 		this->towns.Sort();
 	}
 
 	/** Sort by town name */
 	static int CDECL TownNameSorter(const Town * const *a, const Town * const *b)
 	{
-		static char buf_cache[64];
-		const Town *ta = *a;
-		const Town *tb = *b;
-		char buf[64];
-
-		SetDParam(0, ta->index);
-		GetString(buf, STR_TOWN_NAME, lastof(buf));
-
-		/* If 'b' is the same town as in the last round, use the cached value
-		 * We do this to speed stuff up ('b' is called with the same value a lot of
-		 * times after eachother) */
-		if (tb != last_town) {
-			last_town = tb;
-			SetDParam(0, tb->index);
-			GetString(buf_cache, STR_TOWN_NAME, lastof(buf_cache));
-		}
+		return strnatcmp(town_names.Get((*a)->index), town_names.Get((*b)->index)); // Sort by name (natural sorting).
+	}
 
-		return strnatcmp(buf, buf_cache); // Sort by name (natural sorting).
+	/** Determine the names of the towns, before sorting them by their name */
+	static void CDECL TownNameSortKeys(const Town * const *towns, uint count)
+	{
+		town_names.Clear();
+		for (uint i = 0; i < count; i++) {
+			char buf[64];
+			SetDParam(0, towns[i]->index);
+			GetString(buf, STR_TOWN_NAME, lastof(buf));
+			town_names.Set(towns[i]->index, buf);
+		}
 	}
 
 	/** Sort by population */
@@ -692,7 +687,7 @@ public:
 		this->vscroll = this->GetScrollbar(WID_TD_SCROLLBAR);
 
 		this->towns.SetListing(this->last_sorting);
-		this->towns.SetSortFuncs(TownDirectoryWindow::sorter_funcs);
+		this->towns.SetSortFuncs(TownDirectoryWindow::sorter_funcs, TownDirectoryWindow::sort_key_funcs);
 		this->towns.ForceRebuild();
 		this->BuildSortTownList();
 
@@ -877,7 +872,7 @@ public:
 };
 
 Listing TownDirectoryWindow::last_sorting = {false, 0};
-const Town *TownDirectoryWindow::last_town = NULL;
+GUIListStrings TownDirectoryWindow::town_names;
 
 /* Available town directory sorting functions */
 GUITownList::SortFunction * const TownDirectoryWindow::sorter_funcs[] = {
@@ -885,6 +880,12 @@ GUITownList::SortFunction * const TownDirectoryWindow::sorter_funcs[] = {
 	&TownPopulationSorter,
 };
 
+/* Functions determining the sort keys of the town directory sorting functions */
+GUITownList::SortKeyFunction * const TownDirectoryWindow::sort_key_funcs[] = {
+	&TownNameSortKeys,
+	NULL,
+};
+
 static const WindowDesc _town_directory_desc(
 	WDP_AUTO, 208, 202,
 	WC_TOWN_DIRECTORY, WC_NONE,
@@ -66,6 +66,50 @@ struct NewGRFCache {
 	uint8  cache_valid;               ///< Bitset that indicates which cache values are valid.
 };
 
+/** Number of results of NewGRF variables a vehicle remembers. */
+static const uint NEWGRF_VARIABLE_MEMO_SIZE = 4;
+
+/**
+ * Remembered results of NewGRF variables with a parameter, that only depend on
+ * what the #NewGRFCache depends on. They are forgotten together with that cache,
+ * and at the start of every tick.
+ */
+struct NewGRFVariableMemo {
+	/** A remembered result. */
+	struct Entry {
+		uint32 parameter;                          ///< The parameter of the variable.
+		uint32 value;                              ///< The result.
+		byte variable;                             ///< The variable.
+	};
+
+	Entry entries[NEWGRF_VARIABLE_MEMO_SIZE];      ///< The remembered results.
+	uint16 tick;                                   ///< The tick the results were remembered in.
+	uint8 count;                                   ///< Number of valid entries.
+	uint8 next;                                    ///< Entry to replace when all are valid.
+};
+
+/** Number of callback results a vehicle remembers. */
+static const uint NEWGRF_CALLBACK_CACHE_SIZE = 8;
+
+/**
+ * Remembered results of NewGRF callbacks of a vehicle. They are forgotten
+ * together with the #NewGRFCache, when the cargo of the vehicle changes, and
+ * at the start of every tick and every command.
+ */
+struct NewGRFCallbackCache {
+	/** A remembered result. */
+	struct Entry {
+		uint32 param1;                             ///< First parameter of the callback.
+		uint16 callback;                           ///< The callback.
+		uint16 result;                             ///< The result of the callback.
+	};
+
+	Entry entries[NEWGRF_CALLBACK_CACHE_SIZE];     ///< The remembered results.
+	uint32 generation;                             ///< Generation of the callback caches the results were remembered in.
+	uint8 count;                                   ///< Number of valid entries.
+	uint8 next;                                    ///< Entry to replace when all are valid.
+};
+
 /** Meaning of the various bits of the visual effect. */
 enum VisualEffect {
 	VE_OFFSET_START        = 0, ///< First bit that contains the offset (0 = front, 8 = centre, 15 = rear)
@@ -233,6 +277,8 @@ public:
 	byte subtype;                       ///< subtype (Filled with values from #EffectVehicles/#TrainSubTypes/#AircraftSubTypes)
 
 	NewGRFCache grf_cache;              ///< Cache of often used calculated NewGRF values
+	NewGRFVariableMemo grf_memo;        ///< Remembered results of NewGRF variables with a parameter.
+	NewGRFCallbackCache grf_callback_cache; ///< Remembered results of NewGRF callbacks.
 	VehicleCache vcache;                ///< Cache of often used vehicle values.
 
 	Vehicle(VehicleType type = VEH_INVALID);
@@ -353,6 +399,17 @@ public:
 	inline void InvalidateNewGRFCache()
 	{
 		this->grf_cache.cache_valid = 0;
+		this->grf_memo.count = 0;
+		this->InvalidateNewGRFCallbackCache();
+	}
+
+	/**
+	 * Invalidates the remembered results of NewGRF callbacks, e.g. because the cargo changed.
+	 * @see InvalidateNewGRFCache
+	 */
+	inline void InvalidateNewGRFCallbackCache()
+	{
+		this->grf_callback_cache.count = 0;
 	}
 
 	/**
@@ -349,6 +349,8 @@ static CommandCost RefitVehicle(Vehicle *v, bool only_this, uint8 num_vehicles,
 		/* Restore the original cargo type */
 		v->cargo_type = temp_cid;
 		v->cargo_subtype = temp_subtype;
+		/* Forget what was determined for the new cargo type, also by the front of the chain. */
+		v->First()->InvalidateNewGRFCacheOfChain();
 
 		bool auto_refit_allowed;
 		CommandCost refit_cost = GetRefitCost(v, v->engine_type, new_cid, new_subtype, &auto_refit_allowed);
@@ -55,6 +55,7 @@ static GUIVehicleList::SortFunction VehicleValueSorter;
 static GUIVehicleList::SortFunction VehicleLengthSorter;
 static GUIVehicleList::SortFunction VehicleTimeToLiveSorter;
 static GUIVehicleList::SortFunction VehicleTimetableDelaySorter;
+static GUIVehicleList::SortKeyFunction VehicleNameSortKeys;
 
 GUIVehicleList::SortFunction * const BaseVehicleListWindow::vehicle_sorter_funcs[] = {
 	&VehicleNumberSorter,
@@ -72,6 +73,23 @@ GUIVehicleList::SortFunction * const BaseVehicleListWindow::vehicle_sorter_funcs
 	&VehicleTimetableDelaySorter,
 };
 
+GUIVehicleList::SortKeyFunction * const BaseVehicleListWindow::vehicle_sort_key_funcs[] = {
+	NULL,
+	&VehicleNameSortKeys,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+assert_compile(lengthof(BaseVehicleListWindow::vehicle_sort_key_funcs) == lengthof(BaseVehicleListWindow::vehicle_sorter_funcs));
+
 const StringID BaseVehicleListWindow::vehicle_sorter_names[] = {
 	STR_SORT_BY_NUMBER,
 	STR_SORT_BY_NAME,
@@ -168,15 +186,9 @@ DropDownList *BaseVehicleListWindow::BuildActionDropdownList(bool show_autorepla
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { NULL, NULL };
-
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehicles.Sort()) return;
-
-	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = NULL;
+	this->vehicles.Sort();
 }
 
 void DepotSortList(VehicleList *list)
@@ -986,24 +998,25 @@ static int CDECL VehicleNumberSorter(const Vehicle * const *a, const Vehicle * c
 	return (*a)->unitnumber - (*b)->unitnumber;
 }
 
-/** Sort vehicles by their name */
-static int CDECL VehicleNameSorter(const Vehicle * const *a, const Vehicle * const *b)
-{
-	static char last_name[2][64];
-
-	if (*a != _last_vehicle[0]) {
-		_last_vehicle[0] = *a;
-		SetDParam(0, (*a)->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
+/** Names of the vehicles of the list that is being sorted by name. */
+static GUIListStrings _vehicle_sort_names;
 
-	if (*b != _last_vehicle[1]) {
-		_last_vehicle[1] = *b;
-		SetDParam(0, (*b)->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
+/** Determine the names of the vehicles, before sorting them by their name */
+static void CDECL VehicleNameSortKeys(const Vehicle * const *vehicles, uint count)
+{
+	_vehicle_sort_names.Clear();
+	for (uint i = 0; i < count; i++) {
+		char name[64];
+		SetDParam(0, vehicles[i]->index);
+		GetString(name, STR_VEHICLE_NAME, lastof(name));
+		_vehicle_sort_names.Set(vehicles[i]->index, name);
 	}
+}
 
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+/** Sort vehicles by their name */
+static int CDECL VehicleNameSorter(const Vehicle * const *a, const Vehicle * const *b)
+{
+	int r = strnatcmp(_vehicle_sort_names.Get((*a)->index), _vehicle_sort_names.Get((*b)->index)); // Sort by name (natural sorting).
 	return (r != 0) ? r : VehicleNumberSorter(a, b);
 }
 
@@ -37,10 +37,11 @@ struct BaseVehicleListWindow : public Window {
 	static const StringID vehicle_depot_name[];
 	static const StringID vehicle_sorter_names[];
 	static GUIVehicleList::SortFunction * const vehicle_sorter_funcs[];
+	static GUIVehicleList::SortKeyFunction * const vehicle_sort_key_funcs[];
 
 	BaseVehicleListWindow(WindowNumber wno) : Window(), vli(wno)
 	{
-		this->vehicles.SetSortFuncs(this->vehicle_sorter_funcs);
+		this->vehicles.SetSortFuncs(this->vehicle_sorter_funcs, this->vehicle_sort_key_funcs);
 	}
 
 	void DrawVehicleListItems(VehicleID selected_vehicle, int line_height, const Rect &r) const;
@@ -45,6 +45,7 @@
 #include "window_func.h"
 #include "tilehighlight_func.h"
 #include "window_gui.h"
+#include "smallmap_gui.h"
 
 #include "table/strings.h"
 #include "table/palettes.h"
@@ -142,9 +143,12 @@ struct ViewportDrawer {
 	FoundationPart foundation_part;                  ///< Currently active foundation for ground sprite drawing.
 	int *last_foundation_child[FOUNDATION_PART_END]; ///< Tail of ChildSprite list of the foundations. (index into child_screen_sprites_to_draw)
 	Point foundation_offset[FOUNDATION_PART_END];    ///< Pixel offset for ground sprites on the foundations.
+
+	bool prefetch;                                   ///< Only queue the sprites for prefetching instead of collecting them for drawing.
 };
 
 static void MarkViewportDirty(const ViewPort *vp, int left, int top, int right, int bottom);
+static void ViewportPrefetchScroll(const ViewPort *vp, int dx, int dy);
 
 static ViewportDrawer _vd;
 
@@ -314,6 +318,8 @@ static void SetViewportPosition(Window *w, int x, int y)
 
 	if (old_top == 0 && old_left == 0) return;
 
+	ViewportPrefetchScroll(vp, -old_left, -old_top);
+
 	_vp_move_offs.x = old_left;
 	_vp_move_offs.y = old_top;
 
@@ -487,6 +493,11 @@ static void AddTileSpriteToDraw(SpriteID image, PaletteID pal, int32 x, int32 y,
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	if (_vd.prefetch) {
+		PrefetchSprite(image & SPRITE_MASK);
+		return;
+	}
+
 	TileSpriteToDraw *ts = _vd.tile_sprites_to_draw.Append();
 	ts->image = image;
 	ts->pal = pal;
@@ -650,6 +661,11 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	if (_vd.prefetch) {
+		if (image != SPR_EMPTY_BOUNDING_BOX) PrefetchSprite(image & SPRITE_MASK);
+		return;
+	}
+
 	/* make the sprites transparent with the right palette */
 	if (transparent) {
 		SetBit(image, PALETTE_MODIFIER_TRANSPARENT);
@@ -803,6 +819,11 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	if (_vd.prefetch) {
+		PrefetchSprite(image & SPRITE_MASK);
+		return;
+	}
+
 	/* If the ParentSprite was clipped by the viewport bounds, do not draw the ChildSprites either */
 	if (_vd.last_child == NULL) return;
 
@@ -1508,6 +1529,72 @@ void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom
 	_vd.child_screen_sprites_to_draw.Clear();
 }
 
+/**
+ * Queue the sprites of an area of a viewport for prefetching, so they are
+ * likely in the sprite cache by the time the area is drawn.
+ * @param vp The viewport.
+ * @param left Left side of the area, in virtual coordinates.
+ * @param top Top side of the area, in virtual coordinates.
+ * @param right Right side of the area, in virtual coordinates.
+ * @param bottom Bottom side of the area, in virtual coordinates.
+ */
+static void ViewportPrefetch(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &_vd.dpi;
+
+	_vd.dpi.zoom = vp->zoom;
+	int mask = ScaleByZoom(-1, vp->zoom);
+
+	_vd.combine_sprites = SPRITE_COMBINE_NONE;
+
+	_vd.dpi.width = (right - left) & mask;
+	_vd.dpi.height = (bottom - top) & mask;
+	_vd.dpi.left = left & mask;
+	_vd.dpi.top = top & mask;
+	_vd.dpi.pitch = 0;
+	_vd.dpi.dst_ptr = NULL;
+	_vd.last_child = NULL;
+	_vd.prefetch = true;
+
+	ViewportAddLandscape();
+	ViewportAddVehicles(&_vd.dpi);
+
+	_vd.prefetch = false;
+	_cur_dpi = old_dpi;
+
+	_vd.string_sprites_to_draw.Clear();
+	_vd.tile_sprites_to_draw.Clear();
+	_vd.parent_sprites_to_draw.Clear();
+	_vd.child_screen_sprites_to_draw.Clear();
+}
+
+/** Number of frames of scrolling to prefetch the sprites for. */
+static const int VIEWPORT_PREFETCH_FRAMES = 8;
+
+/**
+ * Queue the sprites that come into view when a viewport keeps scrolling in the same direction.
+ * @param vp The viewport, already at its new position.
+ * @param dx Number of pixels the viewport scrolled to the right.
+ * @param dy Number of pixels the viewport scrolled down.
+ */
+static void ViewportPrefetchScroll(const ViewPort *vp, int dx, int dy)
+{
+	/* Look a few frames ahead, but never further than half the viewport. */
+	int depth_x = min(ScaleByZoom(abs(dx) * VIEWPORT_PREFETCH_FRAMES, vp->zoom), vp->virtual_width / 2);
+	int depth_y = min(ScaleByZoom(abs(dy) * VIEWPORT_PREFETCH_FRAMES, vp->zoom), vp->virtual_height / 2);
+
+	int left = vp->virtual_left;
+	int top = vp->virtual_top;
+	int right = vp->virtual_left + vp->virtual_width;
+	int bottom = vp->virtual_top + vp->virtual_height;
+
+	if (dx > 0) ViewportPrefetch(vp, right, top, right + depth_x, bottom);
+	if (dx < 0) ViewportPrefetch(vp, left - depth_x, top, left, bottom);
+	if (dy > 0) ViewportPrefetch(vp, left, bottom, right, bottom + depth_y);
+	if (dy < 0) ViewportPrefetch(vp, left, top - depth_y, right, top);
+}
+
 /**
  * Make sure we don't draw a too big area at a time.
  * If we do, the sprite memory will overflow.
@@ -1712,6 +1799,7 @@ void MarkTileDirtyByTile(TileIndex tile)
 		pt.x - 31  * ZOOM_LVL_BASE + 67  * ZOOM_LVL_BASE,
 		pt.y - 122 * ZOOM_LVL_BASE + 154 * ZOOM_LVL_BASE
 	);
+	InvalidateSmallMapTile(tile);
 }
 
 /**
@@ -33,6 +33,7 @@
 #include "statusbar_gui.h"
 #include "error.h"
 #include "game/game.hpp"
+#include "spritecache.h"
 
 /** Values for _settings_client.gui.auto_scrolling */
 enum ViewportAutoscrolling {
@@ -51,6 +52,27 @@ Window *_z_front_window = NULL;
 /** List of windows opened at the screen sorted from the back. */
 Window *_z_back_window  = NULL;
 
+/** Number of lists in #_window_index; a power of 2 larger than the number of window classes. */
+static const uint WINDOW_INDEX_SIZE = 128;
+
+/**
+ * The windows, including the closed ones that are not freed yet, in lists
+ * by their window class, so finding the windows of a class does not need
+ * to go through all windows. Classes only share a list when there are more
+ * classes than lists.
+ */
+static SmallVector<Window *, 4> _window_index[WINDOW_INDEX_SIZE];
+
+/**
+ * Iterate over the open windows of a class, in no particular order.
+ * Windows may be opened or closed while iterating.
+ * @param w The variable to assign the windows to.
+ * @param cls The window class.
+ */
+#define FOR_ALL_WINDOWS_OF_CLASS(w, cls) \
+	for (uint _wi = 0; _wi < _window_index[(cls) % WINDOW_INDEX_SIZE].Length(); _wi++) \
+		if ((w = _window_index[(cls) % WINDOW_INDEX_SIZE][_wi])->window_class == (cls) && (cls) != WC_INVALID)
+
 /** If false, highlight is white, otherwise the by the widget defined colour. */
 bool _window_highlight_colour = false;
 
@@ -846,7 +868,7 @@ Window::~Window()
 Window *FindWindowById(WindowClass cls, WindowNumber number)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
 		if (w->window_class == cls && w->window_number == number) return w;
 	}
 
@@ -862,9 +884,7 @@ Window *FindWindowById(WindowClass cls, WindowNumber number)
 Window *FindWindowByClass(WindowClass cls)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) return w;
-	}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) return w;
 
 	return NULL;
 }
@@ -1118,6 +1138,22 @@ static void AddWindowToZOrdering(Window *w)
 }
 
 
+/**
+ * Remove a window that is about to be freed from #_window_index.
+ * @param w Window to remove.
+ */
+static void RemoveWindowFromIndex(Window *w)
+{
+	/* The window is closed, so its class is not known anymore. */
+	for (uint i = 0; i < WINDOW_INDEX_SIZE; i++) {
+		Window **found = _window_index[i].Find(w);
+		if (found != _window_index[i].End()) {
+			_window_index[i].Erase(found);
+			return;
+		}
+	}
+}
+
 /**
  * Removes a window from the z-ordering.
  * @param w Window to remove
@@ -1196,6 +1232,7 @@ void Window::InitializeData(const WindowDesc *desc, WindowNumber window_number)
 
 	/* Insert the window into the correct location in the z-ordering. */
 	AddWindowToZOrdering(this);
+	*_window_index[this->window_class % WINDOW_INDEX_SIZE].Append() = this;
 }
 
 /**
@@ -1601,6 +1638,7 @@ void UnInitWindowSystem()
 
 	_z_front_window = NULL;
 	_z_back_window = NULL;
+	for (uint i = 0; i < WINDOW_INDEX_SIZE; i++) _window_index[i].Clear();
 }
 
 /**
@@ -2697,6 +2735,7 @@ void InputLoop()
 		if (w->window_class != WC_INVALID) continue;
 
 		RemoveWindowFromZOrdering(w);
+		RemoveWindowFromIndex(w);
 		free(w);
 	}
 
@@ -2752,6 +2791,7 @@ void UpdateWindows()
 	}
 
 	DrawDirtyBlocks();
+	IncreaseSpriteLRU();
 
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		/* Update viewport only if window is not shaded. */
@@ -2770,7 +2810,7 @@ void UpdateWindows()
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
 	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
 		if (w->window_class == cls && w->window_number == number) w->SetDirty();
 	}
 }
@@ -2784,7 +2824,7 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
 	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
 		if (w->window_class == cls && w->window_number == number) {
 			w->SetWidgetDirty(widget_index);
 		}
@@ -2798,9 +2838,7 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
 void SetWindowClassesDirty(WindowClass cls)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) w->SetDirty();
-	}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) w->SetDirty();
 }
 
 /**
@@ -2812,8 +2850,10 @@ void Window::InvalidateData(int data, bool gui_scope)
 {
 	this->SetDirty();
 	if (!gui_scope) {
-		/* Schedule GUI-scope invalidation for next redraw. */
-		*this->scheduled_invalidation_data.Append() = data;
+		/* Schedule GUI-scope invalidation for next redraw. The game often
+		 * invalidates a window with the same data many times in a tick;
+		 * one GUI-scope call is enough for those. */
+		this->scheduled_invalidation_data.Include(data);
 	}
 	this->OnInvalidateData(data, gui_scope);
 }
@@ -2870,7 +2910,7 @@ void Window::ProcessHighlightedInvalidations()
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
 	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) {
 		if (w->window_class == cls && w->window_number == number) {
 			w->InvalidateData(data, gui_scope);
 		}
@@ -2888,12 +2928,7 @@ void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool g
 void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
 	Window *w;
-
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) {
-			w->InvalidateData(data, gui_scope);
-		}
-	}
+	FOR_ALL_WINDOWS_OF_CLASS(w, cls) w->InvalidateData(data, gui_scope);
 }
 
 /**